@@ -0,0 +1,135 @@
+/*
+ File: FastMath.h
+ Created on: 17/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FASTMATH_H_
+#define FASTMATH_H_
+
+#define FASTMATH_INLINE inline __attribute__((always_inline))
+
+/** \brief Float approximations of pow() and sin() for the GCC vector types (float __attribute__((vector_size))).
+ * They only use arithmetic, comparisons and bit operations so every lane is computed at once with the instruction
+ * set of the caller.
+ *
+ */
+namespace FastMath
+{
+    static const float PI = 3.14159265358979f;   /** pi.                       */
+    static const int SIGN_BIT = -0x7FFFFFFF - 1; /** sign bit of a float lane. */
+
+    /** \brief Rounds every lane to the nearest integer, ties to even. Valid for |x| < 2^22.
+     * \param[in] x values.
+     *
+     */
+    template <typename F>
+    FASTMATH_INLINE F round(const F& x)
+    {
+        // Adding 1.5 * 2^23 leaves no fraction bits in the mantissa.
+        const float magic = 12582912.f;
+        return (x + magic) - magic;
+    }
+
+    /** \brief Returns the base 2 logarithm of every lane. Error below 1.5e-7 * max(1, |log2(x)|) for normal
+     * positive values, the result is undefined for zero, negative or denormal values.
+     * \param[in] x values.
+     *
+     */
+    template <typename F>
+    FASTMATH_INLINE F log2(const F& x)
+    {
+        using I = decltype(x < x);
+
+        // x = 2^e * m with m in [sqrt(2)/2, sqrt(2)).
+        const I bits = (I)x;
+        const I top = (bits & 0x7FFFFF) > 0x3504F3;
+        const I exponent = ((bits >> 23) & 0xFF) - 127 - top;
+        const I mantissa = (bits & 0x7FFFFF) | (0x3F800000 + (top & ~0x7FFFFF));
+        const F m = (F)mantissa;
+
+        // log2(m) = 2/ln(2) * atanh(t), with t = (m - 1)/(m + 1) in [-0.172, 0.172].
+        const F t = (m - 1.f) / (m + 1.f);
+        const F t2 = t * t;
+        const F series = t * (2.88539008f + t2 * (0.961796694f + t2 * (0.577078016f + t2 * 0.412198583f)));
+
+        return __builtin_convertvector(exponent, F) + series;
+    }
+
+    /** \brief Returns 2 raised to every lane. Relative error below 2.5e-7, lanes are clamped to [-126, 127].
+     * \param[in] x values.
+     *
+     */
+    template <typename F>
+    FASTMATH_INLINE F exp2(const F& x)
+    {
+        using I = decltype(x < x);
+
+        // 2^x = 2^n * 2^f, with n integer and f in [-0.5, 0.5].
+        const F clamped = x < -126.f ? -126.f : (x > 127.f ? 127.f : x);
+        const F n = round(clamped);
+        const F f = (clamped - n) * 0.693147181f;
+
+        // e^f, Taylor series to the sixth power.
+        const F p = 1.f + f * (1.f + f * (0.5f + f * (1.f / 6 + f * (1.f / 24 + f * (1.f / 120 + f * (1.f / 720))))));
+
+        const I scale = (__builtin_convertvector(n, I) + 127) << 23;
+        return p * (F)scale;
+    }
+
+    /** \brief Returns every lane raised to the given exponent. Relative error below 6e-6 for bases in
+     * [1e-6, 1] and exponents in [0.25, 4], the ranges of the squirge fields. The error comes from rounding
+     * exponent * log2(base) to float and is lower for exponents near 1. Lanes lesser or equal to zero return zero.
+     * \param[in] base values.
+     * \param[in] exponent exponent.
+     *
+     */
+    template <typename F>
+    FASTMATH_INLINE F pow(const F& base, const float exponent)
+    {
+        const F result = exp2(exponent * log2(base));
+        return base > 0.f ? result : F{};
+    }
+
+    /** \brief Returns the sine of every lane. Absolute error below 2.5e-7 for |x| < 100, the argument is reduced
+     * to [-pi/2, pi/2] so the error grows with |x|.
+     * \param[in] x values in radians.
+     *
+     */
+    template <typename F>
+    FASTMATH_INLINE F sin(const F& x)
+    {
+        using I = decltype(x < x);
+
+        // x = k * pi + r, with pi split in three parts so the products are exact.
+        const F k = round(x * (1.f / PI));
+        F r = x - k * 3.140625f;
+        r = r - k * 9.67025756836e-4f;
+        r = r - k * 6.27711415291e-7f;
+
+        // Taylor series to the eleventh power, the truncation error is below 6e-8 in [-pi/2, pi/2].
+        const F r2 = r * r;
+        const F s = r * (1.f + r2 * (-1.f / 6 + r2 * (1.f / 120 + r2 * (-1.f / 5040 + r2 * (1.f / 362880 + r2 *
+                                                                                               (-1.f / 39916800))))));
+
+        // sin(k * pi + r) = (-1)^k * sin(r), the mask of the odd lanes selects the sign bit.
+        const I odd = (__builtin_convertvector(k, I) & 1) != 0;
+        const I bits = (I)s ^ (odd & SIGN_BIT);
+        return (F)bits;
+    }
+} // namespace FastMath
+
+#endif // FASTMATH_H_
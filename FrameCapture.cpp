@@ -0,0 +1,140 @@
+/*
+ File: FrameCapture.cpp
+ Created on: 17/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <FrameCapture.h>
+#include <external/gl_loader.h>
+
+// C++
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    const GLuint64 FENCE_TIMEOUT = 1000000;     /** fence wait timeout in nanoseconds, waits again on timeout. */
+    const GLenum TARGET = GL_PIXEL_PACK_BUFFER; /** binding point of the buffers, unbound after each use.     */
+} // namespace
+
+//--------------------------------------------------------------------
+FrameCapture::FrameCapture(GLState& state, FrameWriter& writer, const int buffers) :
+    m_state(state),
+    m_writer(writer),
+    m_count{std::max(buffers, 1)},
+    m_size{static_cast<GLsizeiptr>(writer.width()) * writer.height() * 4},
+    m_buffers(m_count, 0),
+    m_fences(m_count, nullptr),
+    m_next{0},
+    m_pending{0},
+    m_good{true}
+{
+    glGenBuffers(m_count, m_buffers.data());
+    for (const auto buffer : m_buffers) {
+        glBindBuffer(TARGET, buffer);
+        glBufferData(TARGET, m_size, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(TARGET, 0);
+}
+
+//--------------------------------------------------------------------
+FrameCapture::~FrameCapture()
+{
+    finish();
+    glDeleteBuffers(m_count, m_buffers.data());
+}
+
+//--------------------------------------------------------------------
+bool FrameCapture::capture()
+{
+    if (!m_good) {
+        return false;
+    }
+
+    if (m_pending == m_count) {
+        collect(true);
+    }
+
+    m_state.bindFramebuffer(0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glBindBuffer(TARGET, m_buffers[m_next]);
+    glReadPixels(0, 0, m_writer.width(), m_writer.height(), GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(TARGET, 0);
+    m_state.count(5);
+
+    m_fences[m_next] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    m_next = (m_next + 1) % m_count;
+    ++m_pending;
+
+    while (m_pending > 0 && collect(false)) {
+    }
+
+    return m_good;
+}
+
+//--------------------------------------------------------------------
+bool FrameCapture::finish()
+{
+    while (m_pending > 0) {
+        collect(true);
+    }
+
+    return m_good;
+}
+
+//--------------------------------------------------------------------
+bool FrameCapture::collect(const bool wait)
+{
+    const int oldest = (m_next - m_pending + m_count) % m_count;
+    auto& fence = m_fences[oldest];
+
+    // A zero timeout only polls, the flush makes sure the fence is eventually signaled. After a failure the frames
+    // in flight are dropped without waiting.
+    GLenum result = GL_WAIT_FAILED;
+    if (m_good) {
+        do {
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? FENCE_TIMEOUT : 0);
+        } while (wait && result == GL_TIMEOUT_EXPIRED);
+
+        if (result == GL_TIMEOUT_EXPIRED) {
+            return false;
+        }
+    }
+
+    glDeleteSync(fence);
+    fence = nullptr;
+    --m_pending;
+
+    // A frame that can't be read back stops the capture, skipping it would leave a shorter recording.
+    if (result == GL_WAIT_FAILED) {
+        m_good = false;
+        return true;
+    }
+
+    auto frame = m_writer.buffer();
+    glBindBuffer(TARGET, m_buffers[oldest]);
+    const void* data = glMapBufferRange(TARGET, 0, m_size, GL_MAP_READ_BIT);
+    if (data) {
+        std::memcpy(frame.data(), data, m_size);
+    }
+    const bool mapped = data && glUnmapBuffer(TARGET) == GL_TRUE;
+    glBindBuffer(TARGET, 0);
+
+    // The writer only copies the pixels and writes in its own thread.
+    m_good = mapped && m_writer.push(std::move(frame));
+    return true;
+}
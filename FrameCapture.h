@@ -0,0 +1,91 @@
+/*
+ File: FrameCapture.h
+ Created on: 17/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAMECAPTURE_H_
+#define FRAMECAPTURE_H_
+
+// Project
+#include <FrameWriter.h>
+#include <RenderPass.h>
+
+// OpenGL
+#include <GL/gl.h>
+#include <GL/glext.h>
+
+// C++
+#include <vector>
+
+/** \class FrameCapture
+ * \brief Reads the default framebuffer into a ring of pixel pack buffers without waiting for the GPU. Each frame
+ * starts the copy into the next buffer and fences it, the buffers are mapped and queued to the writer once their
+ * fence is signaled, usually some frames later. The render loop only waits when every buffer is still in flight.
+ *
+ */
+class FrameCapture
+{
+  public:
+    /** \brief FrameCapture class constructor. Creates the buffers.
+     * \param[in] state GL state cache used to bind the default framebuffer.
+     * \param[in] writer writer of the frames, its size is the size of the captured area.
+     * \param[in] buffers number of frames in flight.
+     *
+     */
+    explicit FrameCapture(GLState& state, FrameWriter& writer, const int buffers = 3);
+
+    /** \brief FrameCapture class destructor. Queues the frames in flight and deletes the buffers.
+     *
+     */
+    ~FrameCapture();
+
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    /** \brief Starts the copy of the back buffer of the default framebuffer, call it before swapping, and queues the
+     * copies already finished. Returns false if a frame couldn't be read back or written, the capture stops then
+     * instead of dropping frames.
+     *
+     */
+    bool capture();
+
+    /** \brief Waits for the frames in flight and queues them. Returns false if a frame couldn't be read back or
+     * written.
+     *
+     */
+    bool finish();
+
+  private:
+    /** \brief Maps the oldest frame in flight and queues it, or drops it after a failure. Returns false if it isn't
+     * finished and not waiting.
+     * \param[in] wait true to wait for the copy to finish.
+     *
+     */
+    bool collect(const bool wait);
+
+    GLState& m_state;              /** GL state cache.                          */
+    FrameWriter& m_writer;         /** writer of the frames.                    */
+    const int m_count;             /** number of buffers.                       */
+    const GLsizeiptr m_size;       /** size in bytes of a frame.                */
+    std::vector<GLuint> m_buffers; /** pixel pack buffers.                      */
+    std::vector<GLsync> m_fences;  /** fences of the copies in flight, or null. */
+    int m_next;                    /** buffer of the next copy.                 */
+    int m_pending;                 /** number of copies in flight.              */
+    bool m_good;                   /** false after a frame couldn't be queued.  */
+};
+
+#endif // FRAMECAPTURE_H_
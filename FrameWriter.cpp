@@ -0,0 +1,381 @@
+/*
+ File: FrameWriter.cpp
+ Created on: 17/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <FrameWriter.h>
+
+// C++
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdio>
+
+namespace
+{
+    const std::size_t STORED_BLOCK = 65535; /** maximum size of an uncompressed deflate block.               */
+    const std::size_t ADLER_BLOCK = 5552;   /** maximum bytes added to the Adler-32 sums before the modulo.  */
+
+    //--------------------------------------------------------------------
+    // CRC-32 of the PNG chunks, continuing the given one.
+    std::uint32_t crc32(std::uint32_t crc, const std::uint8_t* data, const std::size_t size)
+    {
+        static const auto table = []() {
+            std::array<std::uint32_t, 256> values;
+            for (std::uint32_t i = 0; i < 256; ++i) {
+                std::uint32_t value = i;
+                for (int bit = 0; bit < 8; ++bit) {
+                    value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+                }
+                values[i] = value;
+            }
+            return values;
+        }();
+
+        crc = ~crc;
+        for (std::size_t i = 0; i < size; ++i) {
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        }
+        return ~crc;
+    }
+
+    //--------------------------------------------------------------------
+    void putBigEndian(std::vector<std::uint8_t>& data, const std::uint32_t value)
+    {
+        data.push_back(value >> 24);
+        data.push_back((value >> 16) & 0xFF);
+        data.push_back((value >> 8) & 0xFF);
+        data.push_back(value & 0xFF);
+    }
+
+    //--------------------------------------------------------------------
+    // Writes a PNG chunk, the length, the type, the data and the CRC of the type and the data.
+    void writeChunk(std::ofstream& file, const char* type, const std::vector<std::uint8_t>& data)
+    {
+        std::vector<std::uint8_t> header;
+        putBigEndian(header, static_cast<std::uint32_t>(data.size()));
+        header.insert(header.end(), type, type + 4);
+
+        std::vector<std::uint8_t> footer;
+        putBigEndian(footer, crc32(crc32(0, header.data() + 4, 4), data.data(), data.size()));
+
+        file.write(reinterpret_cast<const char*>(header.data()), header.size());
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+        file.write(reinterpret_cast<const char*>(footer.data()), footer.size());
+    }
+
+    //--------------------------------------------------------------------
+    // Returns the name of the given image of a sequence, the number goes before the extension.
+    std::string imageName(const std::string& filename, const unsigned long long frame)
+    {
+        char number[32];
+        std::snprintf(number, sizeof(number), "_%06llu", frame);
+
+        const auto dot = filename.find_last_of('.');
+        const auto slash = filename.find_last_of("/\\");
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+            return filename + number + ".png";
+        }
+
+        return filename.substr(0, dot) + number + filename.substr(dot);
+    }
+} // namespace
+
+//--------------------------------------------------------------------
+FrameWriter::FrameWriter(const std::string& filename, const Format format, const int width, const int height,
+                         const int fps, const int queueSize) :
+    m_filename{filename},
+    m_format{format},
+    m_width{std::max(width, 1)},
+    m_height{std::max(height, 1)},
+    m_queueSize{static_cast<std::size_t>(std::max(queueSize, 1))},
+    m_frames{0},
+    m_good{true},
+    m_stop{false}
+{
+    if (m_format != Format::PNG) {
+        m_file.open(m_filename, std::ios::out | std::ios::binary | std::ios::trunc);
+        m_good = static_cast<bool>(m_file);
+    }
+
+    // The samples are full range, readers assume limited range unless told otherwise.
+    if (m_good && m_format == Format::Y4M) {
+        m_file << "YUV4MPEG2 W" << m_width << " H" << m_height << " F" << std::max(fps, 1)
+               << ":1 Ip A1:1 C420jpeg XCOLORRANGE=FULL\n";
+    }
+
+    m_thread = std::thread(&FrameWriter::run, this);
+}
+
+//--------------------------------------------------------------------
+FrameWriter::~FrameWriter()
+{
+    finish();
+}
+
+//--------------------------------------------------------------------
+bool FrameWriter::formatOf(const std::string& filename, Format& format)
+{
+    const auto dot = filename.find_last_of('.');
+    if (dot == std::string::npos) {
+        return false;
+    }
+
+    std::string extension = filename.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](const char c) { return std::tolower(c); });
+
+    if (extension == "y4m") {
+        format = Format::Y4M;
+    } else if (extension == "raw" || extension == "rgb") {
+        format = Format::RAW;
+    } else if (extension == "png") {
+        format = Format::PNG;
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------
+bool FrameWriter::isOpen() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_good;
+}
+
+//--------------------------------------------------------------------
+std::vector<std::uint8_t> FrameWriter::buffer()
+{
+    std::vector<std::uint8_t> frame;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_free.empty()) {
+            frame = std::move(m_free.back());
+            m_free.pop_back();
+        }
+    }
+
+    frame.resize(static_cast<std::size_t>(m_width) * m_height * 4);
+    return frame;
+}
+
+//--------------------------------------------------------------------
+bool FrameWriter::push(std::vector<std::uint8_t>&& frame)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_written.wait(lock, [this]() { return m_queue.size() < m_queueSize || !m_good; });
+    if (!m_good || m_stop) {
+        return false;
+    }
+
+    m_queue.push_back(std::move(frame));
+    lock.unlock();
+    m_queued.notify_one();
+
+    return true;
+}
+
+//--------------------------------------------------------------------
+void FrameWriter::finish()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_queued.notify_one();
+
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+
+    if (m_file.is_open()) {
+        m_file.close();
+
+        // The last bytes are flushed on close.
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_good &= !m_file.fail();
+    }
+}
+
+//--------------------------------------------------------------------
+unsigned long long FrameWriter::frames() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_frames;
+}
+
+//--------------------------------------------------------------------
+void FrameWriter::run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_queued.wait(lock, [this]() { return !m_queue.empty() || m_stop; });
+        if (m_queue.empty()) {
+            break;
+        }
+
+        // The queue stays locked only to take and return the frames.
+        auto frame = std::move(m_queue.front());
+        m_queue.pop_front();
+        const bool good = m_good;
+        lock.unlock();
+
+        const bool written = good && write(frame);
+
+        lock.lock();
+        m_good = written;
+        m_frames += written ? 1 : 0;
+        if (m_free.size() < m_queueSize) {
+            m_free.push_back(std::move(frame));
+        }
+        m_written.notify_all();
+    }
+}
+
+//--------------------------------------------------------------------
+bool FrameWriter::write(const std::vector<std::uint8_t>& frame)
+{
+    const std::size_t width = m_width;
+    const std::size_t height = m_height;
+
+    // Rows of the frame from top to bottom.
+    const auto row = [&frame, width, height](const std::size_t y) {
+        return frame.data() + (height - 1 - y) * width * 4;
+    };
+
+    switch (m_format) {
+        case Format::Y4M:
+        {
+            // Full range BT.601 in 8 bit fixed point, the chroma is the average of each 2x2 block.
+            const std::size_t chromaWidth = (width + 1) / 2;
+            const std::size_t chromaHeight = (height + 1) / 2;
+            m_scratch.resize(width * height + 2 * chromaWidth * chromaHeight);
+            std::uint8_t* luma = m_scratch.data();
+            std::uint8_t* blue = luma + width * height;
+            std::uint8_t* red = blue + chromaWidth * chromaHeight;
+
+            const auto toLuma = [](const std::uint8_t* pixel) {
+                return static_cast<std::uint8_t>((77 * pixel[0] + 150 * pixel[1] + 29 * pixel[2] + 128) >> 8);
+            };
+
+            // The last row and column are repeated on odd sizes, same as averaging the pixels of the smaller blocks.
+            for (std::size_t cy = 0; cy < chromaHeight; ++cy) {
+                const std::size_t y0 = 2 * cy;
+                const std::size_t y1 = std::min(y0 + 1, height - 1);
+                const std::uint8_t* row0 = row(y0);
+                const std::uint8_t* row1 = row(y1);
+
+                for (std::size_t x = 0; x < width; ++x) {
+                    luma[y0 * width + x] = toLuma(row0 + 4 * x);
+                    luma[y1 * width + x] = toLuma(row1 + 4 * x);
+                }
+
+                for (std::size_t cx = 0; cx < chromaWidth; ++cx) {
+                    const std::size_t x0 = 4 * (2 * cx);
+                    const std::size_t x1 = 4 * std::min(2 * cx + 1, width - 1);
+                    const int r = row0[x0] + row0[x1] + row1[x0] + row1[x1];
+                    const int g = row0[x0 + 1] + row0[x1 + 1] + row1[x0 + 1] + row1[x1 + 1];
+                    const int b = row0[x0 + 2] + row0[x1 + 2] + row1[x0 + 2] + row1[x1 + 2];
+
+                    // Sums of 4 pixels, the offset adds 128 and rounds, pure blue or red would round to 256.
+                    const int offset = (128 << 10) + 512;
+                    blue[cy * chromaWidth + cx] = std::min((-43 * r - 85 * g + 128 * b + offset) >> 10, 255);
+                    red[cy * chromaWidth + cx] = std::min((128 * r - 107 * g - 21 * b + offset) >> 10, 255);
+                }
+            }
+
+            m_file << "FRAME\n";
+            m_file.write(reinterpret_cast<const char*>(m_scratch.data()), m_scratch.size());
+            return static_cast<bool>(m_file);
+        }
+        case Format::RAW:
+        {
+            m_scratch.resize(width * height * 3);
+            for (std::size_t y = 0; y < height; ++y) {
+                const std::uint8_t* pixels = row(y);
+                std::uint8_t* rgb = m_scratch.data() + y * width * 3;
+                for (std::size_t x = 0; x < width; ++x) {
+                    rgb[3 * x] = pixels[4 * x];
+                    rgb[3 * x + 1] = pixels[4 * x + 1];
+                    rgb[3 * x + 2] = pixels[4 * x + 2];
+                }
+            }
+
+            m_file.write(reinterpret_cast<const char*>(m_scratch.data()), m_scratch.size());
+            return static_cast<bool>(m_file);
+        }
+        case Format::PNG:
+        default:
+        {
+            std::ofstream file(imageName(m_filename, m_frames), std::ios::out | std::ios::binary | std::ios::trunc);
+            const std::uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+            file.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+            // 8 bit RGB, no interlacing.
+            std::vector<std::uint8_t> header;
+            putBigEndian(header, m_width);
+            putBigEndian(header, m_height);
+            header.insert(header.end(), {8, 2, 0, 0, 0});
+            writeChunk(file, "IHDR", header);
+
+            // Rows without filter, each one starts with the filter type.
+            std::vector<std::uint8_t> rows(height * (1 + width * 3));
+            for (std::size_t y = 0; y < height; ++y) {
+                const std::uint8_t* pixels = row(y);
+                std::uint8_t* rgb = rows.data() + y * (1 + width * 3);
+                rgb[0] = 0;
+                for (std::size_t x = 0; x < width; ++x) {
+                    rgb[1 + 3 * x] = pixels[4 * x];
+                    rgb[2 + 3 * x] = pixels[4 * x + 1];
+                    rgb[3 + 3 * x] = pixels[4 * x + 2];
+                }
+            }
+
+            // zlib stream of stored deflate blocks, compression would make the writer the slowest stage.
+            m_scratch.clear();
+            m_scratch.push_back(0x78);
+            m_scratch.push_back(0x01);
+            std::uint32_t a = 1, b = 0;
+            for (std::size_t offset = 0; offset < rows.size(); offset += STORED_BLOCK) {
+                const std::size_t size = std::min(STORED_BLOCK, rows.size() - offset);
+                m_scratch.push_back(offset + size == rows.size() ? 1 : 0);
+                m_scratch.push_back(size & 0xFF);
+                m_scratch.push_back(size >> 8);
+                m_scratch.push_back(~size & 0xFF);
+                m_scratch.push_back((~size >> 8) & 0xFF);
+                m_scratch.insert(m_scratch.end(), rows.begin() + offset, rows.begin() + offset + size);
+
+                // The sums can't overflow in a stored block before the modulo.
+                for (std::size_t i = offset; i < offset + size; i += ADLER_BLOCK) {
+                    for (std::size_t j = i; j < std::min(i + ADLER_BLOCK, offset + size); ++j) {
+                        a += rows[j];
+                        b += a;
+                    }
+                    a %= 65521;
+                    b %= 65521;
+                }
+            }
+            putBigEndian(m_scratch, (b << 16) | a);
+
+            writeChunk(file, "IDAT", m_scratch);
+            writeChunk(file, "IEND", std::vector<std::uint8_t>());
+            return static_cast<bool>(file);
+        }
+    }
+}
@@ -0,0 +1,147 @@
+/*
+ File: FrameWriter.h
+ Created on: 17/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAMEWRITER_H_
+#define FRAMEWRITER_H_
+
+// C++
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/** \class FrameWriter
+ * \brief Writes captured frames to a video file or an image sequence in a thread of its own. The frames are RGBA
+ * bytes with the rows from bottom to top, like glReadPixels(), and wait in a bounded queue, so the caller only blocks
+ * when the writer falls behind by more than the queue size. The frame buffers are recycled once written.
+ * Formats:
+ * - Y4M: YUV4MPEG2 video, 4:2:0 full range BT.601 declared with XCOLORRANGE=FULL, readable by ffmpeg.
+ * - RAW: rgb24 frames, top to bottom, without header.
+ * - PNG: one uncompressed RGB image per frame, the frame number is appended to the file name.
+ *
+ */
+class FrameWriter
+{
+  public:
+    enum class Format : char { Y4M = 0, RAW = 1, PNG = 2 };
+
+    /** \brief FrameWriter class constructor. Creates the file and starts the writer thread, check with isOpen().
+     * \param[in] filename video file name, or the name of the images with the number before the extension.
+     * \param[in] format file format.
+     * \param[in] width frame width in pixels.
+     * \param[in] height frame height in pixels.
+     * \param[in] fps frames per second of the video.
+     * \param[in] queueSize maximum number of frames waiting to be written.
+     *
+     */
+    explicit FrameWriter(const std::string& filename, const Format format, const int width, const int height,
+                         const int fps = 60, const int queueSize = 4);
+
+    /** \brief FrameWriter class destructor. Writes the queued frames and stops the writer thread.
+     *
+     */
+    ~FrameWriter();
+
+    FrameWriter(const FrameWriter&) = delete;
+    FrameWriter& operator=(const FrameWriter&) = delete;
+
+    /** \brief Returns the format of the given file name extension, y4m, raw or png, returns false if unknown.
+     * \param[in] filename file name.
+     * \param[out] format file format.
+     *
+     */
+    static bool formatOf(const std::string& filename, Format& format);
+
+    /** \brief Returns true if the file was created and all the writes succeeded.
+     *
+     */
+    bool isOpen() const;
+
+    /** \brief Returns a buffer for a frame, width * height * 4 bytes, reusing the ones already written.
+     *
+     */
+    std::vector<std::uint8_t> buffer();
+
+    /** \brief Queues the given frame, waits while the queue is full. Returns false if a write failed.
+     * \param[in] frame RGBA frame from buffer().
+     *
+     */
+    bool push(std::vector<std::uint8_t>&& frame);
+
+    /** \brief Writes the queued frames and stops the writer thread, no frames can be pushed after this call.
+     *
+     */
+    void finish();
+
+    /** \brief Returns the number of frames written.
+     *
+     */
+    unsigned long long frames() const;
+
+    /** \brief Returns the frame width in pixels.
+     *
+     */
+    inline int width() const
+    {
+        return m_width;
+    }
+
+    /** \brief Returns the frame height in pixels.
+     *
+     */
+    inline int height() const
+    {
+        return m_height;
+    }
+
+  private:
+    /** \brief Writer thread loop.
+     *
+     */
+    void run();
+
+    /** \brief Writes the given frame, returns false on error.
+     * \param[in] frame RGBA frame.
+     *
+     */
+    bool write(const std::vector<std::uint8_t>& frame);
+
+    const std::string m_filename;                  /** video file or image names.                    */
+    const Format m_format;                         /** file format.                                  */
+    const int m_width;                             /** frame width in pixels.                        */
+    const int m_height;                            /** frame height in pixels.                       */
+    const std::size_t m_queueSize;                 /** maximum number of queued frames.              */
+    std::ofstream m_file;                          /** video file, not used by the image sequences.  */
+    std::vector<std::uint8_t> m_scratch;           /** converted frame of the writer thread.         */
+    mutable std::mutex m_mutex;                    /** protects the queues and the counters.         */
+    std::condition_variable m_queued;              /** signals the writer a queued frame or the end. */
+    std::condition_variable m_written;             /** signals the callers a free queue slot.        */
+    std::deque<std::vector<std::uint8_t>> m_queue; /** frames waiting to be written.                 */
+    std::vector<std::vector<std::uint8_t>> m_free; /** buffers of the written frames.                */
+    unsigned long long m_frames;                   /** number of frames written.                     */
+    bool m_good;                                   /** false after a failed write.                   */
+    bool m_stop;                                   /** true to stop the writer once the queue empty. */
+    std::thread m_thread;                          /** writer thread.                                */
+};
+
+#endif // FRAMEWRITER_H_
@@ -0,0 +1,388 @@
+/*
+ File: Kernels.cpp
+ Created on: 17/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// The FastMath functions are always inlined, their vector arguments never use the calling convention.
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+// Project
+#include <FastMath.h>
+#include <Kernels.h>
+
+// C++
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define KERNELS_X86 1
+#endif
+
+#define KERNEL_INLINE inline __attribute__((always_inline))
+
+static const double TWO_PI = 6.283185307179586; /** 2 * pi, M_PI isn't defined in strict ANSI mode. */
+
+using namespace Kernels;
+
+namespace
+{
+    /** \struct Vector
+     * \brief Vector type of W lanes.
+     *
+     */
+    template <int W>
+    struct Vector
+    {
+        typedef float f __attribute__((vector_size(W * sizeof(float))));
+    };
+
+    //--------------------------------------------------------------------
+    void advanceScalar(const Fields& fields, float* px, float* py, const int begin, const int end)
+    {
+        for (int i = begin; i < end; ++i) {
+            double x = px[i];
+            double y = py[i];
+
+            // Squirge towards edges (makes a leaf shape, previously split the screen in 4 but now only 1 :)
+            // These ones must go first, to avoid x+1.0 < 0
+            if (fields.enabled[6]) {
+                x = -1.0 + 2.0 * std::pow((x + 1.0) / 2.0, fields.var[6]);
+            }
+
+            if (fields.enabled[7]) {
+                y = -1.0 + 2.0 * std::pow((y + 1.0) / 2.0, fields.var[7]);
+            }
+
+            /* Warping in/out */
+            if (fields.enabled[1]) {
+                x = x * fields.var[1];
+                y = y * fields.var[1];
+            }
+
+            /* Rotation */
+            if (fields.enabled[2]) {
+                const auto nx = x * fields.cosRotation + y * fields.sinRotation;
+                const auto ny = -x * fields.sinRotation + y * fields.cosRotation;
+                x = nx;
+                y = ny;
+            }
+
+            /* Asymptotes (looks like a plane with a horizon; equivalent to 1D warp) */
+            if (fields.enabled[3]) {
+                /* Horizontal asymptote */
+                y = y * fields.var[3];
+            }
+
+            if (fields.enabled[4]) {
+                /* Vertical asymptote */
+                x = x + fields.var[4] * x; /* this is the same maths as the last, but with op=0 */
+            }
+
+            if (fields.enabled[5]) {
+                /* Vertical asymptote at right of screen */
+                x = (x - 1.0) * fields.var[5] + 1.0;
+            }
+
+            /* Splitting (whirlwind effect): */
+            auto thru = [&fields, i](int splits) {
+                return static_cast<float>(
+                           static_cast<int>(splits * static_cast<float>(i) / static_cast<float>(fields.numPoints))) /
+                       static_cast<float>(splits - 1);
+            };
+
+            if (fields.enabled[8]) {
+                x = x + 0.5 * fields.var[8] * (-1.0 + 2.0 * thru(fields.numSplits));
+            }
+
+            if (fields.enabled[9]) {
+                y = y + 0.5 * fields.var[9] * (-1.0 + 2.0 * thru(fields.numSplits));
+            }
+
+            /* Waves */
+            if (fields.enabled[10]) {
+                y = y + 0.4 * fields.var[10] * std::sin(300.0 * fields.var[12] * x + 600.0 * fields.var[11]);
+            }
+
+            if (fields.enabled[13]) {
+                x = x + 0.4 * fields.var[13] * std::sin(300.0 * fields.var[15] * y + 600.0 * fields.var[14]);
+            }
+
+            px[i] = x;
+            py[i] = y;
+        }
+    }
+
+    //--------------------------------------------------------------------
+    // Advances W particles starting at x and y. offset is the split offset of the range of the particles.
+    template <int W, unsigned int Mask>
+    KERNEL_INLINE void advanceBlock(const Fields& fields, float* px, float* py, const SplitRange& offset)
+    {
+        using vf = typename Vector<W>::f;
+
+        vf x, y;
+        std::memcpy(&x, px, sizeof(vf));
+        std::memcpy(&y, py, sizeof(vf));
+
+        if constexpr (Mask & SQUIRGE_X) {
+            x = -1.f + 2.f * FastMath::pow((x + 1.f) * 0.5f, fields.var[6]);
+        }
+
+        if constexpr (Mask & SQUIRGE_Y) {
+            y = -1.f + 2.f * FastMath::pow((y + 1.f) * 0.5f, fields.var[7]);
+        }
+
+        if constexpr (Mask & AFFINE) {
+            const auto& m = fields.affine;
+            const vf nx = x * m[0] + y * m[1] + m[2];
+            const vf ny = x * m[3] + y * m[4] + m[5];
+            x = nx;
+            y = ny;
+        }
+
+        if constexpr (Mask & SPLIT) {
+            x = x + offset.x;
+            y = y + offset.y;
+        }
+
+        if constexpr (Mask & WAVE_Y) {
+            y = y + fields.waveY[0] * FastMath::sin(x * fields.waveY[1] + fields.waveY[2]);
+        }
+
+        if constexpr (Mask & WAVE_X) {
+            x = x + fields.waveX[0] * FastMath::sin(y * fields.waveX[1] + fields.waveX[2]);
+        }
+
+        std::memcpy(px, &x, sizeof(vf));
+        std::memcpy(py, &y, sizeof(vf));
+    }
+
+    //--------------------------------------------------------------------
+    // Advances the particles in [begin, end), all of them with the given split offset.
+    template <int W, unsigned int Mask>
+    KERNEL_INLINE void advanceRange(const Fields& fields, float* px, float* py, const int begin, const int end,
+                                    const SplitRange& offset)
+    {
+        int i = begin;
+        for (; i + W <= end; i += W) {
+            advanceBlock<W, Mask>(fields, px + i, py + i, offset);
+        }
+
+        if (i < end) {
+            // Pad the remaining particles to a full vector.
+            const auto size = (end - i) * sizeof(float);
+            float x[W] = {0}, y[W] = {0};
+            std::memcpy(x, px + i, size);
+            std::memcpy(y, py + i, size);
+            advanceBlock<W, Mask>(fields, x, y, offset);
+            std::memcpy(px + i, x, size);
+            std::memcpy(py + i, y, size);
+        }
+    }
+
+    //--------------------------------------------------------------------
+    template <int W, unsigned int Mask>
+    KERNEL_INLINE void advanceVector(const Fields& fields, float* px, float* py, const int begin, const int end)
+    {
+        if constexpr (Mask & SPLIT) {
+            // Advance the part of every split range inside [begin, end) with its constant offset.
+            const auto& ranges = fields.splitRanges;
+            auto range = std::upper_bound(ranges.cbegin(), ranges.cend(), begin,
+                                          [](const int i, const SplitRange& r) { return i < r.end; });
+
+            int i = begin;
+            for (; range != ranges.cend() && i < end; ++range) {
+                const int rangeEnd = std::min(range->end, end);
+                advanceRange<W, Mask>(fields, px, py, i, rangeEnd, *range);
+                i = rangeEnd;
+            }
+        } else {
+            advanceRange<W, Mask>(fields, px, py, begin, end, SplitRange{end, 0.f, 0.f});
+        }
+    }
+
+#ifdef KERNELS_X86
+    /** \struct SSE4
+     * \brief SSE4.1 kernels, 4 lanes.
+     *
+     */
+    struct SSE4
+    {
+        template <unsigned int Mask>
+        __attribute__((target("sse4.1"))) static void advance(const Fields& fields, float* x, float* y, const int begin,
+                                                              const int end)
+        {
+            advanceVector<4, Mask>(fields, x, y, begin, end);
+        }
+    };
+
+    /** \struct AVX2
+     * \brief AVX2 kernels, 8 lanes.
+     *
+     */
+    struct AVX2
+    {
+        template <unsigned int Mask>
+        __attribute__((target("avx2"))) static void advance(const Fields& fields, float* x, float* y, const int begin,
+                                                            const int end)
+        {
+            advanceVector<8, Mask>(fields, x, y, begin, end);
+        }
+    };
+
+    /** \struct AVX512
+     * \brief AVX-512 kernels, 16 lanes.
+     *
+     */
+    struct AVX512
+    {
+        template <unsigned int Mask>
+        __attribute__((target("avx512f"))) static void advance(const Fields& fields, float* x, float* y,
+                                                               const int begin, const int end)
+        {
+            advanceVector<16, Mask>(fields, x, y, begin, end);
+        }
+    };
+
+    //--------------------------------------------------------------------
+    // Dispatch table of an instruction set, indexed by stages mask.
+    template <typename Set, std::size_t... Masks>
+    constexpr std::array<Advance, STAGES> table(std::index_sequence<Masks...>)
+    {
+        return {{&Set::template advance<Masks>...}};
+    }
+
+    const auto SSE4_KERNELS = table<SSE4>(std::make_index_sequence<STAGES>());
+    const auto AVX2_KERNELS = table<AVX2>(std::make_index_sequence<STAGES>());
+    const auto AVX512_KERNELS = table<AVX512>(std::make_index_sequence<STAGES>());
+#endif
+} // namespace
+
+//--------------------------------------------------------------------
+void Kernels::prepare(Fields& fields)
+{
+    const auto& enabled = fields.enabled;
+    const auto& var = fields.var;
+
+    fields.cosRotation = std::cos(1.1 * var[2]);
+    fields.sinRotation = std::sin(1.1 * var[2]);
+    fields.numSplits = 2 + static_cast<int>(std::fabs(var[0]) * 1000);
+
+    // Particle i is in the split range int(splits * i / numPoints). The boundaries are found with the same float
+    // expression so every particle gets the offset of the reference.
+    fields.splitRanges.clear();
+    if (enabled[8] || enabled[9]) {
+        const auto splits = fields.numSplits;
+        const auto n = fields.numPoints;
+        const float factor[2] = {enabled[8] ? 0.5f * var[8] : 0.f, enabled[9] ? 0.5f * var[9] : 0.f};
+        auto rangeOf = [splits, n](const int i) {
+            return static_cast<int>(splits * static_cast<float>(i) / static_cast<float>(n));
+        };
+
+        for (int range = 0; range < splits; ++range) {
+            auto end = static_cast<int>((static_cast<long long>(range) + 1) * n / splits);
+            while (end > 0 && rangeOf(end - 1) > range) {
+                --end;
+            }
+            while (end < n && rangeOf(end) <= range) {
+                ++end;
+            }
+
+            const float thru = -1.f + 2.f * (static_cast<float>(range) / static_cast<float>(splits - 1));
+            fields.splitRanges.push_back(SplitRange{end, factor[0] * thru, factor[1] * thru});
+        }
+    }
+
+    // The phases are reduced in double precision, the float sine is only accurate for small arguments.
+    fields.waveY[0] = 0.4 * var[10];
+    fields.waveY[1] = 300.0 * var[12];
+    fields.waveY[2] = std::remainder(600.0 * var[11], TWO_PI);
+    fields.waveX[0] = 0.4 * var[13];
+    fields.waveX[1] = 300.0 * var[15];
+    fields.waveX[2] = std::remainder(600.0 * var[14], TWO_PI);
+
+    unsigned int mask = 0;
+    mask |= enabled[6] ? SQUIRGE_X : 0;
+    mask |= enabled[7] ? SQUIRGE_Y : 0;
+    mask |= (enabled[1] || enabled[2] || enabled[3] || enabled[4] || enabled[5]) ? AFFINE : 0;
+    mask |= (enabled[8] || enabled[9]) ? SPLIT : 0;
+    mask |= enabled[10] ? WAVE_Y : 0;
+    mask |= enabled[13] ? WAVE_X : 0;
+    fields.mask = mask;
+}
+
+//--------------------------------------------------------------------
+Kernels::Isa Kernels::detectIsa()
+{
+#ifdef KERNELS_X86
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512f")) {
+        return Isa::AVX512;
+    }
+
+    if (__builtin_cpu_supports("avx2")) {
+        return Isa::AVX2;
+    }
+
+    if (__builtin_cpu_supports("sse4.1")) {
+        return Isa::SSE4;
+    }
+#endif
+
+    return Isa::SCALAR;
+}
+
+//--------------------------------------------------------------------
+Kernels::Advance Kernels::advanceFunction(const Isa isa, const unsigned int mask)
+{
+    switch (isa) {
+#ifdef KERNELS_X86
+        case Isa::SSE4:
+            return SSE4_KERNELS[mask % STAGES];
+        case Isa::AVX2:
+            return AVX2_KERNELS[mask % STAGES];
+        case Isa::AVX512:
+            return AVX512_KERNELS[mask % STAGES];
+#endif
+        default:
+        case Isa::SCALAR:
+            break;
+    }
+
+    return advanceScalar;
+}
+
+//--------------------------------------------------------------------
+const char* Kernels::isaName(const Isa isa)
+{
+    switch (isa) {
+        case Isa::SSE4:
+            return "SSE4";
+        case Isa::AVX2:
+            return "AVX2";
+        case Isa::AVX512:
+            return "AVX-512";
+        default:
+        case Isa::SCALAR:
+            break;
+    }
+
+    return "scalar";
+}
@@ -0,0 +1,119 @@
+/*
+ File: Kernels.h
+ Created on: 17/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KERNELS_H_
+#define KERNELS_H_
+
+// C++
+#include <vector>
+
+namespace Kernels
+{
+    static const int FIELDS = 16; /** number of force fields. */
+
+    /** \brief Groups of force fields the vector kernels are specialized on.
+     *
+     */
+    enum Stage : unsigned int
+    {
+        SQUIRGE_X = 1 << 0, /** field 6.                      */
+        SQUIRGE_Y = 1 << 1, /** field 7.                      */
+        AFFINE = 1 << 2,    /** fields 1 to 5.                */
+        SPLIT = 1 << 3,     /** fields 8 and 9.               */
+        WAVE_Y = 1 << 4,    /** field 10.                     */
+        WAVE_X = 1 << 5,    /** field 13.                     */
+        STAGES = 1 << 6     /** number of stage combinations. */
+    };
+
+    /** \struct SplitRange
+     * \brief Consecutive particles moved by the same offset of the split fields (8, 9).
+     *
+     */
+    struct SplitRange
+    {
+        int end; /** index past the last particle of the range. */
+        float x; /** x offset.                                   */
+        float y; /** y offset.                                   */
+    };
+
+    /** \struct Fields
+     * \brief Force field parameters of a frame, computed once from the application state before advancing.
+     *
+     */
+    struct Fields
+    {
+        bool enabled[FIELDS]; /** true if the field is on.                                              */
+        float var[FIELDS];    /** current field parameters.                                             */
+        float affine[6];      /** composition of the affine fields (1 to 5), x' = a0*x + a1*y + a2 and
+                                  y' = a3*x + a4*y + a5.                                                */
+        int numPoints;        /** total number of particles.                                            */
+
+        // Values computed by prepare().
+        unsigned int mask;  /** enabled stages.                                  */
+        double cosRotation; /** cosine of the rotation field angle (1.1*var[2]). */
+        double sinRotation; /** sine of the rotation field angle (1.1*var[2]).   */
+        int numSplits;      /** number of splits of the whirlwind fields (8, 9). */
+        float waveY[3];     /** amplitude, frequency and phase of field 10.      */
+        float waveX[3];     /** amplitude, frequency and phase of field 13.      */
+
+        std::vector<SplitRange> splitRanges; /** split ranges in index order, empty if fields 8 and 9 are disabled. */
+    };
+
+    /** \brief Instruction sets with an advance kernel.
+     *
+     */
+    enum class Isa : char { SCALAR = 0, SSE4 = 1, AVX2 = 2, AVX512 = 3 };
+
+    /** \brief Advance kernel signature. Applies the force fields to the positions in [begin, end), the
+     * positions are modified in place.
+     *
+     */
+    using Advance = void (*)(const Fields& fields, float* x, float* y, const int begin, const int end);
+
+    /** \brief Computes the stages mask and the per-frame values of the given fields from the enabled flags,
+     * the parameters and the number of points.
+     * \param[inout] fields force field parameters.
+     *
+     */
+    void prepare(Fields& fields);
+
+    /** \brief Returns the widest instruction set supported by the CPU and the OS.
+     *
+     */
+    Isa detectIsa();
+
+    /** \brief Returns the advance kernel for the given instruction set and stages mask. SCALAR is the reference
+     * implementation, computed in double precision like the original screensaver, applies the fields one after
+     * another and ignores the mask, it's the exact mode used to validate the others. The vector kernels are
+     * instantiated for every mask, apply the affine matrix, use the FastMath approximations of pow() and sin() and
+     * don't branch per particle.
+     * \param[in] isa Instruction set.
+     * \param[in] mask enabled stages.
+     *
+     */
+    Advance advanceFunction(const Isa isa, const unsigned int mask);
+
+    /** \brief Returns the name of the given instruction set.
+     * \param[in] isa Instruction set.
+     *
+     */
+    const char* isaName(const Isa isa);
+} // namespace Kernels
+
+#endif // KERNELS_H_
@@ -20,9 +20,14 @@
 // Project
 #include <WhirlWindWarp.h>
 #include <version.h>
+#include <PlatformUtils.h>
 #include <Utils.h>
 #include <Shaders.h>
 #include <Particle.h>
+#include <StreamBuffer.h>
+#include <RenderPass.h>
+#include <FrameCapture.h>
+#include <FrameWriter.h>
 #include <resources.h>
 
 // GLFW
@@ -44,9 +49,23 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <tchar.h>
+#include <algorithm>
 
-enum class Mode: char { SAVER = 0, CHILD = 1, CONFIG = 2 };
+enum class Mode: char { SAVER = 0, CHILD = 1, CONFIG = 2, RECORD = 3 };
 static Mode g_mode = Mode::CONFIG;
+static std::string g_recordFile; /** video or images recorded in RECORD mode. */
+
+/** \struct MonitorRect
+ * \brief Position and size of a monitor in pixels.
+ *
+ */
+struct MonitorRect
+{
+    int x;      /** left edge.                                 */
+    int y;      /** top edge, or bottom edge with a GL origin. */
+    int width;  /** width.                                     */
+    int height; /** height.                                    */
+};
 
 //---------------------------------------------------------------------------------------
 LRESULT WINAPI ScreenSaverProc (HWND hwnd, UINT iMsg, WPARAM wparam, LPARAM lparam)
@@ -62,11 +81,22 @@ void ScreenSaver()
     int xMin = 0;
     int yMin = 0;
 
-    constexpr GLsizei stride = sizeof(Particle);
-
     Utils::Configuration config;
     Utils::loadConfiguration(config);
 
+    // Positions change every frame and are streamed, colors, widths and birth frames only change on respawn or color
+    // change. The packed format uses normalized integers, 12 bytes per vertex instead of 32.
+    const bool packed = config.packed_vertices;
+    const GLsizei positionStride = packed ? sizeof(std::uint32_t) : 2 * sizeof(float);
+    const GLenum positionType = packed ? GL_SHORT : GL_FLOAT;
+    const GLsizei attributeStride = packed ? 2 * sizeof(std::uint32_t) : 6 * sizeof(float);
+    const GLenum colorType = packed ? GL_UNSIGNED_BYTE : GL_FLOAT;
+    const std::size_t widthOffset = packed ? sizeof(std::uint32_t) : 4 * sizeof(float);
+    const std::size_t birthOffset = packed ? sizeof(std::uint32_t) + 1 : 5 * sizeof(float);
+    const GLint birthSize = packed ? 3 : 1;
+    const GLboolean normalized = packed ? GL_TRUE : GL_FALSE;
+    const float widthScale = packed ? 1.f / PACKED_WIDTH_UNITS : 1.f;
+
     glfwSetErrorCallback(Utils::errorCallback);
 
     if (!glfwInit()) {
@@ -82,6 +112,10 @@ void ScreenSaver()
 
     xMin = std::numeric_limits<int>::max();
     yMin = std::numeric_limits<int>::max();
+    int xMax = std::numeric_limits<int>::min();
+    int yMax = std::numeric_limits<int>::min();
+    long long visibleArea = 0;
+    std::vector<MonitorRect> monitors;
 
     for (int i = 0; i < monitorCount; ++i) {
         const auto glfwmonitor = glfwmonitors[i];
@@ -91,11 +125,16 @@ void ScreenSaver()
 
         xMin = std::min(xMin, xPos);
         yMin = std::min(yMin, yPos);
-        virtualWidth = std::max(virtualWidth, xPos + res->width);
-        virtualHeight = std::max(virtualHeight, yPos + res->height);
+        xMax = std::max(xMax, xPos + res->width);
+        yMax = std::max(yMax, yPos + res->height);
+        visibleArea += static_cast<long long>(res->width) * res->height;
+        monitors.push_back(MonitorRect{xPos, yPos, res->width, res->height});
     }
 
-    const int numPoints = (virtualWidth * virtualHeight) / config.pixelsPerPoint;
+    // The window covers the bounding box of the monitors, the density only counts the pixels they show.
+    virtualWidth = xMax - xMin;
+    virtualHeight = yMax - yMin;
+    const int numPoints = static_cast<int>(visibleArea / config.pixelsPerPoint);
 
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
@@ -107,7 +146,24 @@ void ScreenSaver()
     glfwWindowHint(GLFW_POSITION_Y, yMin);
 
     WhirlWindWarp www(numPoints, config);
-    const float* vertices = www.buffer();
+
+    // When the monitors don't cover the window the particles only spawn inside them and the full screen passes only
+    // fill them. The scissors are in pixels of the window with the origin at the bottom left.
+    std::vector<MonitorRect> scissors;
+    if (visibleArea < static_cast<long long>(virtualWidth) * virtualHeight) {
+        std::vector<Particles::Area> areas;
+        for (const auto& monitor : monitors) {
+            const int left = monitor.x - xMin;
+            const int bottom = virtualHeight - (monitor.y - yMin) - monitor.height;
+            scissors.push_back(MonitorRect{left, bottom, monitor.width, monitor.height});
+
+            const float toX = 2.f / virtualWidth;
+            const float toY = 2.f / virtualHeight;
+            areas.push_back(Particles::Area{left * toX - 1.f, bottom * toY - 1.f, (left + monitor.width) * toX - 1.f,
+                                            (bottom + monitor.height) * toY - 1.f});
+        }
+        www.particles().setAreas(areas);
+    }
 
     GLFWwindow* window = glfwCreateWindow(virtualWidth, virtualHeight, "Monitor", nullptr, nullptr);
     if (!window) {
@@ -124,7 +180,8 @@ void ScreenSaver()
     glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
     glfwSetInputMode(window, GLFW_RAW_MOUSE_MOTION, GLFW_TRUE);
     glfwSetWindowOpacity(window, 1.f);
-    glfwSwapInterval(1);
+    // Recording isn't tied to the refresh rate, every frame is a step of the simulation.
+    glfwSwapInterval(g_mode == Mode::RECORD ? 0 : 1);
 
     if (load_gl_functions() > 0) {
         glfwTerminate();
@@ -144,200 +201,341 @@ void ScreenSaver()
 
     Utils::initProgram(points);
 
+    // Trails are quads, drawn as instances or expanded from lines in the geometry shader.
     Utils::GL_program trails = Utils::GL_program("trails");
-    trails.vert = Utils::loadShader(vertexShaderSourceTrails, GL_VERTEX_SHADER);
-    trails.geom = Utils::loadShader(geometryShaderSource, GL_GEOMETRY_SHADER);
+    if (config.instanced_trails) {
+        trails.vert = Utils::loadShader(vertexShaderSourceTrailsInstanced, GL_VERTEX_SHADER);
+    } else {
+        trails.vert = Utils::loadShader(vertexShaderSourceTrails, GL_VERTEX_SHADER);
+        trails.geom = Utils::loadShader(geometryShaderSource, GL_GEOMETRY_SHADER);
+    }
     trails.frag = Utils::loadShader(fragmentShaderSourceTrails, GL_FRAGMENT_SHADER);
 
     Utils::initProgram(trails);
 
-    const GLint uratioX = glGetUniformLocation(trails.program, "ratioX");
-    const GLint uratioY = glGetUniformLocation(trails.program, "ratioY");
-
     Utils::GL_program post = Utils::GL_program("post-processing");
     post.vert = Utils::loadShader(ppVertexShaderSource, GL_VERTEX_SHADER);
     post.frag = Utils::loadShader(ppFragmentShaderSource, GL_FRAGMENT_SHADER);
 
     Utils::initProgram(post);
 
-    // Create VAO and VBO
-    GLuint VAO, VBO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
+    Utils::GL_program decay = Utils::GL_program("decay");
+    decay.vert = Utils::loadShader(ppVertexShaderSource, GL_VERTEX_SHADER);
+    decay.frag = Utils::loadShader(decayFragmentShaderSource, GL_FRAGMENT_SHADER);
+
+    Utils::initProgram(decay);
+
+    // The trails are the positions of the last frames, kept as the history of the streaming VBO and read through a
+    // buffer texture, that limits the regions that can be kept.
+    bool showTrails = config.show_trails;
+    int trailLength = std::clamp<int>(config.trail_length, 1, Utils::MAX_TRAIL_LENGTH);
+    if (showTrails) {
+        GLint maxTexels = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+        trailLength = std::min(trailLength, maxTexels / numPoints - 3);
+        showTrails = trailLength > 0;
+    }
 
-    const int multiplier = config.show_trails ? 2 : 1;
+    // Create the streaming VBO of the positions and the VBO of the colors, widths and birth frames. The simulation
+    // writes the positions of each frame to a region of the streaming VBO that the GPU isn't using.
+    GLuint attributesVBO;
+    glGenBuffers(1, &attributesVBO);
 
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, multiplier * numPoints * stride, vertices, GL_DYNAMIC_DRAW);
+    auto& particles = www.particles();
 
-    // Position attribute
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, (void*)0);
-    glEnableVertexAttribArray(0);
+    const auto numVertices = static_cast<std::size_t>(numPoints);
+    const int history = showTrails ? trailLength : 0;
+    auto positions = std::make_unique<StreamBuffer>(numVertices * positionStride, history + 3, history);
+    const GLuint positionsVBO = positions->buffer();
 
-    // Color attribute
-    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
+    GLuint historyTexture;
+    glGenTextures(1, &historyTexture);
+    glBindTexture(GL_TEXTURE_BUFFER, historyTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, packed ? GL_RG16 : GL_RG32F, positionsVBO);
 
-    // Line/Point width
-    glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, stride, (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
+    // Staging memory of the changed attributes.
+    std::vector<float> attributes(packed ? 0 : particles.attributesSize());
+    std::vector<std::uint32_t> packedAttributes(packed ? particles.packedAttributesSize() : 0);
+    glBindBuffer(GL_ARRAY_BUFFER, attributesVBO);
+    glBufferData(GL_ARRAY_BUFFER, numVertices * attributeStride, nullptr, GL_DYNAMIC_DRAW);
 
-    // Create VAO and VBOs for post-processing quad
-    GLuint quadVAO, quadVBO, quadEBO;    
-    glGenVertexArrays(1, &quadVAO);
+    // Create VBOs for post-processing quad
+    GLuint quadVBO, quadEBO;
     glGenBuffers(1, &quadVBO);
     glGenBuffers(1, &quadEBO);
 
-    glBindVertexArray(quadVAO);
-
     glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), quadVertices, GL_STATIC_DRAW);
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, quadEBO);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(quadIndices), quadIndices, GL_STATIC_DRAW);
 
-    // Position attribute
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
+    // Setup framebuffers and textures to accumulate colors. The motion blur uses them in turns, the previous frame
+    // is faded into the current one, the particles are drawn over it and the result is upscaled to the screen.
+    const int blurScale = (config.blur_scale == 2 || config.blur_scale == 4) ? config.blur_scale : 1;
+    const int drawWidth = config.motion_blur ? std::max(1, virtualWidth / blurScale) : virtualWidth;
+    const int drawHeight = config.motion_blur ? std::max(1, virtualHeight / blurScale) : virtualHeight;
 
-    // Setup framebuffer and texture to accumulate colors
-    GLuint framebuffer;
-    glGenFramebuffers(1, &framebuffer);
-    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    GLuint framebuffers[2] = {0, 0};
+    GLuint textures[2] = {0, 0};
+    if (config.motion_blur) {
+        glGenFramebuffers(2, framebuffers);
+        glGenTextures(2, textures);
 
-    GLuint texture;
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
+        for (int i = 0; i < 2; ++i) {
+            glBindFramebuffer(GL_FRAMEBUFFER, framebuffers[i]);
+            glBindTexture(GL_TEXTURE_2D, textures[i]);
 
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, virtualWidth, virtualHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
-    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, drawWidth, drawHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textures[i], 0);
 
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-        glfwTerminate();
-        Utils::errorCallback(EXIT_FAILURE, "Framebuffer not complete!");
+            if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+                glfwTerminate();
+                Utils::errorCallback(EXIT_FAILURE, "Framebuffer not complete!");
+            }
+
+            glClear(GL_COLOR_BUFFER_BIT);
+        }
     }
 
-    // openg coords are {-1,1} get ratio coords/pixels to pass it as uniforms in the line shaders.
-    float ratioX = 2.f / virtualWidth;
-    float ratioY = 2.f / virtualHeight;
+    // openg coords are {-1,1} get ratio coords/pixels to pass it as uniforms in the line shaders. The widths are in
+    // pixels of the screen, smaller when drawing at a lower resolution.
+    float ratioX = 2.f / drawWidth;
+    float ratioY = 2.f / drawHeight;
+    const float drawWidthScale = widthScale * drawWidth / virtualWidth;
 
     glDisable(GL_CULL_FACE);
     glDisable(GL_DEPTH_TEST);
     glEnable(GL_PROGRAM_POINT_SIZE);
 
+    if (config.antialias) {
+        glEnable(GL_MULTISAMPLE);
+    }
+
+    // The particles are combined with the faded previous frames by their maximum, overlapping particles don't
+    // saturate.
+    glClearColor(0, 0, 0, 1);
+    glBlendEquation(GL_MAX);
+
     glMatrixMode(GL_PROJECTION);
     glLoadIdentity();
     glOrtho(0.0f, virtualWidth, virtualHeight, 0.0f, 0.0f, 1.0f);
 
-    while(!glfwWindowShouldClose(window)) {
-        glfwFocusWindow(window);
-        www.advance();
-
-        glBindFramebuffer(GL_FRAMEBUFFER, (config.motion_blur ? framebuffer : 0));
-        glClearColor(0, 0, 0, 1);
-        glClear(GL_COLOR_BUFFER_BIT);
+    // The points pass has a vertex array per region of the positions, the frame only binds the one of the region
+    // written. The trails pass reads the positions from the history texture, each instance is a particle and each
+    // segment of its trail is a point expanded in the geometry shader or six vertices of two triangles.
+    GLState state;
+    const int regions = positions->regions();
+
+    const GLenum trailsMode = config.instanced_trails ? GL_TRIANGLES : GL_POINTS;
+    const GLsizei trailVertices = config.instanced_trails ? 6 * trailLength : trailLength;
+    auto trailsPass = std::make_unique<RenderPass>(state, trails.program, trailsMode);
+    trailsPass->setAttribute(0, 1, attributesVBO, 4, colorType, normalized, attributeStride, 0, 1);
+    trailsPass->setAttribute(0, 2, attributesVBO, 1, colorType, GL_FALSE, attributeStride, widthOffset, 1);
+    trailsPass->setAttribute(0, 3, attributesVBO, birthSize, colorType, GL_FALSE, attributeStride, birthOffset, 1);
+
+    auto pointsPass = std::make_unique<RenderPass>(state, points.program, GL_POINTS, regions);
+    for (int region = 0; region < regions; ++region) {
+        const auto offset = positions->offset(region);
+        pointsPass->setAttribute(region, 0, positionsVBO, 2, positionType, normalized, positionStride, offset);
+        pointsPass->setAttribute(region, 1, attributesVBO, 4, colorType, normalized, attributeStride, 0);
+        pointsPass->setAttribute(region, 2, attributesVBO, 1, colorType, GL_FALSE, attributeStride, widthOffset);
+    }
 
-        if (config.antialias) {
-            glEnable(GL_MULTISAMPLE);
+    // Packed widths are integers, scaled back to pixels in the vertex shaders.
+    trailsPass->setUniform("widthScale", drawWidthScale);
+    trailsPass->setUniform("ratioX", ratioX);
+    trailsPass->setUniform("ratioY", ratioY);
+    trailsPass->setUniform("packedPositions", packed ? 1 : 0);
+    trailsPass->setUniform("regions", regions);
+    trailsPass->setUniform("numPoints", numPoints);
+    trailsPass->setUniform("trailLength", trailLength);
+    pointsPass->setUniform("widthScale", drawWidthScale);
+
+    // The head and the frame change every frame, their handles skip the lookup by name.
+    const int headUniform = trailsPass->uniform("head");
+    const int frameUniform = trailsPass->uniform("frame");
+
+    auto postPass = std::make_unique<RenderPass>(state, post.program, GL_TRIANGLES);
+    postPass->setAttribute(0, 0, quadVBO, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), 0);
+    postPass->setElements(quadEBO);
+
+    auto decayPass = std::make_unique<RenderPass>(state, decay.program, GL_TRIANGLES);
+    decayPass->setAttribute(0, 0, quadVBO, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), 0);
+    decayPass->setElements(quadEBO);
+    decayPass->setUniform("decay", Utils::BLUR_DECAY);
+
+    int current = 0;
+
+    // The frames are read back asynchronously and written by the writer thread, the loop only waits if the writer
+    // falls behind.
+    std::unique_ptr<FrameWriter> writer;
+    std::unique_ptr<FrameCapture> capture;
+    bool recordFailed = false;
+    if (g_mode == Mode::RECORD) {
+        FrameWriter::Format format;
+        if (!FrameWriter::formatOf(g_recordFile, format)) {
+            glfwTerminate();
+            Utils::errorCallback(EXIT_FAILURE, "Unknown record format, use a .y4m, .raw or .png file name");
         }
 
-        if (config.show_trails) {
-            glUseProgram(trails.program);
-
-            glBindVertexArray(VAO);
-            glBindBuffer(GL_ARRAY_BUFFER, VBO);
-            glBufferData(GL_ARRAY_BUFFER, multiplier * numPoints * stride, vertices, GL_DYNAMIC_DRAW);
-
-            // Position attribute
-            glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, (void*)0);
-            glEnableVertexAttribArray(0);
-
-            // Color attribute
-            glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, (void*)(2 * sizeof(float)));
-            glEnableVertexAttribArray(1);
-
-            // Line/Point width
-            glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, stride, (void*)(6 * sizeof(float)));
-            glEnableVertexAttribArray(2);
-
-            glUniform1fv(uratioX, 1, &ratioX);
-            glUniform1fv(uratioY, 1, &ratioY);
-
-            glDrawArrays(GL_LINES, 0, numPoints * multiplier);
+        writer = std::make_unique<FrameWriter>(g_recordFile, format, virtualWidth, virtualHeight);
+        if (!writer->isOpen()) {
+            glfwTerminate();
+            const std::string msg = std::string("Unable to create record file: ") + g_recordFile;
+            Utils::errorCallback(EXIT_FAILURE, msg.c_str());
         }
 
-        glUseProgram(points.program);
+        capture = std::make_unique<FrameCapture>(state, *writer);
+    }
 
-        glBindVertexArray(VAO);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, multiplier * numPoints * stride, vertices, GL_DYNAMIC_DRAW);
+    // Runs a full screen pass once per monitor when they don't cover the window, scissored to a monitor at the
+    // given fraction of the resolution.
+    const auto forEachMonitor = [&](const int scale, const auto& pass) {
+        if (scissors.empty()) {
+            pass();
+            return;
+        }
 
-        // Position attribute
-        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride * multiplier, (void*)0);
-        glEnableVertexAttribArray(0);
+        state.setEnabled(GL_SCISSOR_TEST, true);
+        for (const auto& rect : scissors) {
+            const int left = rect.x / scale;
+            const int bottom = rect.y / scale;
+            const int right = (rect.x + rect.width + scale - 1) / scale;
+            const int top = (rect.y + rect.height + scale - 1) / scale;
+            state.setScissor(left, bottom, right - left, top - bottom);
+            pass();
+        }
+        state.setEnabled(GL_SCISSOR_TEST, false);
+    };
 
-        // Color attribute
-        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride * multiplier, (void*)(2 * sizeof(float)));
-        glEnableVertexAttribArray(1);
+#ifndef NDEBUG
+    unsigned long long totalCalls = 0;
+    unsigned long long frames = 0;
+#endif
 
-        // Line/Point width
-        glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, stride * multiplier, (void*)(6 * sizeof(float)));
-        glEnableVertexAttribArray(2);
+    while(!glfwWindowShouldClose(window)) {
+        glfwFocusWindow(window);
+        www.advance();
 
-        glDrawArrays(GL_POINTS, 0, numPoints);
+        // Positions are uploaded once per frame, both passes draw from the same region.
+        if (packed) {
+            particles.fillPackedPositions(static_cast<std::uint32_t*>(positions->map()));
+        } else {
+            particles.fillPositions(static_cast<float*>(positions->map()));
+        }
+        positions->unmap();
+        const int region = positions->region();
+
+        // Only the changed colors and widths are uploaded.
+        for (const auto& range : particles.takeChangedRanges()) {
+            const void* data = attributes.data();
+            if (packed) {
+                particles.fillPackedAttributes(packedAttributes.data(), range);
+                data = packedAttributes.data();
+            } else {
+                particles.fillAttributes(attributes.data(), range);
+            }
+            state.bufferSubData(attributesVBO, range.first * attributeStride, range.count * attributeStride, data);
+        }
 
         if (config.motion_blur) {
-            glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_CONSTANT_COLOR, GL_CONSTANT_ALPHA);
-            glBlendColor(1.f, 1.f, 1.f, 0.75f);
-            glBlendEquation(GL_FUNC_ADD);
+            state.bindFramebuffer(framebuffers[current]);
+            state.setViewport(drawWidth, drawHeight);
+            state.bindTexture(textures[1 - current]);
+            forEachMonitor(blurScale, [&]() { decayPass->draw(0, 6); });
+            state.setEnabled(GL_BLEND, true);
+        } else {
+            state.bindFramebuffer(0);
+            forEachMonitor(1, [&]() { state.clear(GL_COLOR_BUFFER_BIT); });
+        }
 
-            glUseProgram(post.program);
+        if (showTrails) {
+            trailsPass->setUniform(headUniform, region);
+            trailsPass->setUniform(frameUniform, static_cast<GLint>(particles.frame() % BIRTH_FRAMES));
+            trailsPass->drawInstanced(0, trailVertices, numPoints);
+        }
 
-            glBindVertexArray(quadVAO);
+        pointsPass->draw(region, numPoints);
 
-            glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, quadEBO);
+        // The region can't be written again until the GPU has finished the passes of this frame and the trails of
+        // the next ones.
+        positions->fence();
 
-            // Position attribute
-            glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
-            glEnableVertexAttribArray(0);
+        if (config.motion_blur) {
+            state.setEnabled(GL_BLEND, false);
+            state.bindFramebuffer(0);
+            state.setViewport(virtualWidth, virtualHeight);
+            state.bindTexture(textures[current]);
+            forEachMonitor(1, [&]() { postPass->draw(0, 6); });
+            current = 1 - current;
+        }
 
-            glBindTexture(GL_TEXTURE_2D, texture);
-            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-            glDisable(GL_BLEND);
+        // A frame that can't be read back or written stops the recording.
+        if (capture && !capture->capture()) {
+            recordFailed = true;
+            glfwSetWindowShouldClose(window, GLFW_TRUE);
         }
 
+        state.endFrame();
+#ifndef NDEBUG
+        totalCalls += state.frameCalls();
+        ++frames;
+#endif
+
         // Swap buffers and poll events
         glfwSwapBuffers(window);
-        glBindVertexArray(0);
         glfwPollEvents();
     }
 
+#ifndef NDEBUG
+    if (frames > 0) {
+        std::cout << "GL calls per frame: " << static_cast<double>(totalCalls) / frames << std::endl;
+    }
+#endif
+
+    // The last frames of the recording are written before the cleanup, a failure is reported after it.
+    if (capture) {
+        recordFailed |= !capture->finish();
+        writer->finish();
+        recordFailed |= !writer->isOpen();
+    }
+
     // Cleanup
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
+    capture = nullptr;
+    writer = nullptr;
+    trailsPass = nullptr;
+    pointsPass = nullptr;
+    postPass = nullptr;
+    decayPass = nullptr;
+    glDeleteBuffers(1, &attributesVBO);
+    glDeleteTextures(1, &historyTexture);
+    positions = nullptr;
     glDeleteProgram(points.program);
     glDeleteProgram(trails.program);
 
-    glDeleteVertexArrays(1, &quadVAO);
     glDeleteBuffers(1, &quadVBO);
     glDeleteBuffers(1, &quadEBO);
-    glDeleteTextures(1, &texture);
-    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteTextures(2, textures);
+    glDeleteFramebuffers(2, framebuffers);
     glDeleteProgram(post.program);
+    glDeleteProgram(decay.program);
 
     glfwDestroyWindow(window);
     glfwTerminate();
 
+    if (recordFailed) {
+        const std::string msg = std::string("Unable to capture or write a frame, the recording is incomplete: ") +
+                                g_recordFile;
+        Utils::errorCallback(EXIT_FAILURE, msg.c_str());
+    }
+
     PostQuitMessage(0);
 }
 
@@ -475,6 +673,21 @@ int APIENTRY wWinMain(HINSTANCE hInstance, HINSTANCE, LPWSTR lpCmdLine, int)
                     finished = true;
                     break;
 
+                case TEXT('r'): // Record to the file that follows
+                case TEXT('R'):
+                {
+                    g_mode = Mode::RECORD;
+                    cmdline++;
+                    while (*cmdline == TEXT(' ') || *cmdline == TEXT('"')) {
+                        cmdline++;
+                    }
+
+                    std::wstring filename(cmdline);
+                    filename.erase(filename.find_last_not_of(L"\" ") + 1);
+                    g_recordFile = Utils::ws2s(filename);
+                    finished = true;
+                    break;
+                }
                 case TEXT('c'): // Show configuration dialog
                 case TEXT('C'):
                     g_mode = Mode::CONFIG;
@@ -490,6 +703,7 @@ int APIENTRY wWinMain(HINSTANCE hInstance, HINSTANCE, LPWSTR lpCmdLine, int)
         {
             case Mode::CHILD:
             case Mode::SAVER:
+            case Mode::RECORD:
                 ScreenSaver();
                 break;
             default:
@@ -24,176 +24,580 @@
 // C++
 #include <cmath>
 #include <algorithm>
-#include <execution>
+#include <cstring>
 #include <cassert>
+#include <limits>
 
 constexpr float FPS60 = 1.f / 60.f;
 
+namespace
+{
+    /** \brief Slots of the per particle random streams. The gap slots are only drawn from the stream of the first
+     * particle of each chunk, the rest only when the particle respawns or changes color.
+     *
+     */
+    enum Slot : std::uint32_t
+    {
+        COLOR_GAP = 0,     /** particles before the color change event of the chunk.      */
+        COLOR_S = 1,       /** saturation of the changed color.                           */
+        COLOR_V = 2,       /** value of the changed color.                                */
+        RESET_X = 3,       /** x position of the respawn.                                 */
+        RESET_Y = 4,       /** y position of the respawn.                                 */
+        RESET_H = 5,       /** hue of the respawn.                                        */
+        RESET_S = 6,       /** saturation of the respawn.                                 */
+        RESET_V = 7,       /** value of the respawn.                                      */
+        RESET_W = 8,       /** width of the respawn.                                      */
+        HUE_INCREMENT = 9, /** hue increment after a color change.                        */
+        RESPAWN_GAP = 10   /** first of the gaps between respawn events, one slot per gap. */
+    };
+
+    // Probabilities of the per particle random events, a roll in [-1,1] above 0.995 and 0.75.
+    const double RESPAWN_PROBABILITY = 0.0025; /** a particle respawns at random. */
+    const double COLOR_PROBABILITY = 0.125;    /** a particle changes its color.   */
+
+    // Changed particle ranges closer than MIN_RANGE_GAP are uploaded as one, and the closest ranges are merged until
+    // there are at most MAX_CHANGED_RANGES. A chunk with more than MAX_CHANGED_PER_CHUNK changes is uploaded whole.
+    const std::uint32_t MIN_RANGE_GAP = 64;         /** particles between two separate ranges. */
+    const std::size_t MAX_CHANGED_RANGES = 128;     /** ranges returned by takeChangedRanges(). */
+    const std::size_t MAX_CHANGED_PER_CHUNK = 2048; /** changed indexes kept per chunk.         */
+
+    /** \brief Returns the smallest float greater or equal to the given value, float x < value is the same as
+     * x < ceilFloat(value).
+     * \param[in] value double value.
+     *
+     */
+    float ceilFloat(const double value)
+    {
+        const auto f = static_cast<float>(value);
+        return f < value ? std::nextafter(f, std::numeric_limits<float>::max()) : f;
+    }
+
+    // Limit of the respawn test in float, same results as the double comparison of the inline path.
+    const float CENTER = ceilFloat(.0001); /** particles closer to the axes respawn. */
+
+    // The packing helpers don't clamp, branches keep the loops from being vectorized. Positions are always inside
+    // (-1,1) after the respawns, colors in [0,1] and widths below 255 / PACKED_WIDTH_UNITS.
+
+    /** \brief Returns the given coordinates in (-1,1) as normalized 16 bit integers in a word, x in the low half.
+     * \param[in] x x coordinate.
+     * \param[in] y y coordinate.
+     *
+     */
+    inline std::uint32_t packPosition(const float x, const float y)
+    {
+        const auto px = static_cast<std::uint16_t>(static_cast<std::int16_t>(x * 32767.f + std::copysign(.5f, x)));
+        const auto py = static_cast<std::uint16_t>(static_cast<std::int16_t>(y * 32767.f + std::copysign(.5f, y)));
+        return px | (static_cast<std::uint32_t>(py) << 16);
+    }
+
+    /** \brief Returns the given rgba color in [0,1] as normalized 8 bit integers in a word, red in the low byte.
+     * \param[in] color rgba components.
+     *
+     */
+    inline std::uint32_t packColor(const float* color)
+    {
+        auto unit = [](const float value) { return static_cast<std::uint32_t>(static_cast<int>(value * 255.f + .5f)); };
+        return unit(color[0]) | (unit(color[1]) << 8) | (unit(color[2]) << 16) | (unit(color[3]) << 24);
+    }
+
+    /** \brief Returns a 64 bit seed drawn from the given generator.
+     * \param[in] generator random number generator in [-1,1].
+     *
+     */
+    std::uint64_t drawSeed(Utils::NumberGenerator* generator)
+    {
+        auto draw = [generator]() {
+            const auto value = (generator->get() + 1.0) * 0.5 * std::numeric_limits<std::uint32_t>::max();
+            return static_cast<std::uint64_t>(value);
+        };
+
+        return (draw() << 32) | draw();
+    }
+} // namespace
+
 //--------------------------------------------------------------------
 Particles::Particles(State& state, Utils::NumberGenerator* generator, const Utils::Configuration& config) :
     m_state{state},
     m_generator{generator},
-    m_config{config}
+    m_config{config},
+    m_inlineRespawn{false},
+    m_random{-1.f, 1.f, drawSeed(generator)},
+    m_frame{0}
 {
     assert(generator);
+    static_assert(Kernels::FIELDS == fs, "Kernel fields and state fields mismatch.");
+
+    setIsa(Kernels::detectIsa());
+    setThreads(0);
     init();
 }
 
 //--------------------------------------------------------------------
 void Particles::advance()
 {
-    const int multiplier = m_config.show_trails ? 2 : 1;
+    ++m_frame;
+
+    // The fields only change between frames, pick the kernel specialized for the enabled ones.
+    Kernels::Fields fields;
+    std::copy(m_state.enabled, m_state.enabled + fs, fields.enabled);
+    std::copy(m_state.var, m_state.var + fs, fields.var);
+    std::copy(m_state.affine, m_state.affine + 6, fields.affine);
+    fields.numPoints = m_state.numPoints;
+    Kernels::prepare(fields);
+
+    const auto kernel = Kernels::advanceFunction(m_isa, fields.mask);
+    const int numChunks = (m_state.numPoints + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    std::vector<int> candidates(numChunks, -1);
+
+    m_pool->parallelFor(numChunks, [&](const int chunk) { candidates[chunk] = advanceChunk(chunk, fields, kernel); });
+
+    // Only one particle changes color per frame, the first one in index order that won the roll. It doesn't depend
+    // on which chunk finished first.
+    const auto winner = std::find_if(candidates.cbegin(), candidates.cend(), [](const int i) { return i != -1; });
+    if (!m_state.changedColor && winner != candidates.cend()) {
+        const int idx = *winner;
+        const Utils::hsv hsvColor(m_state.hue, 0.6 + 0.4 * m_random.get(m_frame, idx, COLOR_S),
+                                  0.6 + 0.4 * m_random.get(m_frame, idx, COLOR_V));
+
+        // Change one of the allocated colours to something near the current hue.
+        // By changing a random colour, we sometimes get a tight colour spread, sometime a diverse one.
+        const auto rgbColor = Utils::hsv2rgb(hsvColor);
+        float* color = m_color.data() + 4 * idx;
+        color[0] = rgbColor.r;
+        color[1] = rgbColor.g;
+        color[2] = rgbColor.b;
+        color[3] = 1.f;
+
+        m_state.hue = m_state.hue + 0.5 + m_random.get(m_frame, idx, HUE_INCREMENT) * 9.0;
+        if (m_state.hue < 0) {
+            m_state.hue += 360;
+        }
+        if (m_state.hue >= 360) {
+            m_state.hue -= 360;
+        }
 
-    for (int i = 0; i < m_state.numPoints; ++i) {
-        Particle* pos = reinterpret_cast<Particle*>(m_buffer.data()) + (i * multiplier);
+        m_state.changedColor = true;
+        markChanged(idx);
+    }
+}
 
-        if (m_config.show_trails) {
-            memcpy(pos + 1, pos, sizeof(Particle));
-        }
+//--------------------------------------------------------------------
+int Particles::advanceChunk(const int chunk, const Kernels::Fields& fields, const Kernels::Advance kernel)
+{
+    const int begin = chunk * CHUNK_SIZE;
+    const int end = std::min(begin + CHUNK_SIZE, m_state.numPoints);
 
-        double x = pos->x;
-        double y = pos->y;
-
-        // In theory all these if checks are unnecessary,
-        // since each forcefield effect should do nothing when its var = op.
-        // But the if's are good for efficiency because this function
-        // is called once for every point.
-        //
-        // Squirge towards edges (makes a leaf shape, previously split the screen in 4 but now only 1 :)
-        // These ones must go first, to avoid x+1.0 < 0
-        if (m_state.enabled[6]) {
-            x = -1.0 + 2.0 * std::pow((x + 1.0) / 2.0, m_state.var[6]);
-        }
+    float* const px = m_x.data();
+    float* const py = m_y.data();
 
-        if (m_state.enabled[7]) {
-            y = -1.0 + 2.0 * std::pow((y + 1.0) / 2.0, m_state.var[7]);
-        }
+    // Apply the force fields to every particle, then respawn them.
+    kernel(fields, px, py, begin, end);
+
+    // Random respawns are rare, sample their indexes instead of rolling for every particle.
+    std::uint32_t events[CHUNK_SIZE];
+    const int numEvents =
+        sampleEvents(m_random, m_frame, begin, end, RESPAWN_GAP, RESPAWN_PROBABILITY, events, CHUNK_SIZE);
 
-        /* Warping in/out */
-        if (m_state.enabled[1]) {
-            x = x * m_state.var[1];
-            y = y * m_state.var[1];
+    if (m_inlineRespawn) {
+        int event = 0;
+        for (int i = begin; i < end; ++i) {
+            const float x = px[i];
+            const float y = py[i];
+
+            const bool random = event < numEvents && events[event] == static_cast<std::uint32_t>(i);
+            event += random;
+
+            // If moved off screen or too centered to move, create a new one.
+            const bool outside = x <= -1.f || x >= 1.f || y <= -1.f || y >= 1.f || fabs(x) < .0001 || fabs(y) < .0001;
+            if (outside || random || (!m_areas.empty() && !visible(x, y))) {
+                reset(i);
+            }
         }
+    } else {
+        // Flag the particles to respawn without branching, then collect the flagged indexes eight at a time. Most
+        // of the flags are zero.
+        const int n = end - begin;
+        alignas(8) std::uint8_t flags[CHUNK_SIZE];
+        for (int i = 0; i < n; ++i) {
+            const float x = px[begin + i];
+            const float y = py[begin + i];
 
-        /* Rotation */
-        if (m_state.enabled[2]) {
-            const auto nx = x * std::cos(1.1 * m_state.var[2]) + y * std::sin(1.1 * m_state.var[2]);
-            const auto ny = -x * std::sin(1.1 * m_state.var[2]) + y * std::cos(1.1 * m_state.var[2]);
-            x = nx;
-            y = ny;
+            // If moved off screen or too centered to move, create a new one.
+            flags[i] = (x <= -1.f) | (x >= 1.f) | (y <= -1.f) | (y >= 1.f) | (std::fabs(x) < CENTER) |
+                       (std::fabs(y) < CENTER);
         }
+        std::fill(flags + n, flags + std::min(CHUNK_SIZE, (n + 7) & ~7), 0);
+
+        // The parts of the space between the monitors aren't shown. One pass per area so the loops vectorize.
+        if (!m_areas.empty()) {
+            alignas(8) std::uint8_t inside[CHUNK_SIZE];
+            std::fill(inside, inside + n, 0);
+            for (const auto& area : m_areas) {
+                const float left = area.left;
+                const float bottom = area.bottom;
+                const float right = area.right;
+                const float top = area.top;
+                for (int i = 0; i < n; ++i) {
+                    const float x = px[begin + i];
+                    const float y = py[begin + i];
+                    inside[i] |= (x > left) & (x < right) & (y > bottom) & (y < top);
+                }
+            }
 
-        /* Asymptotes (looks like a plane with a horizon; equivalent to 1D warp) */
-        if (m_state.enabled[3]) {
-            /* Horizontal asymptote */
-            y = y * m_state.var[3];
+            for (int i = 0; i < n; ++i) {
+                flags[i] |= inside[i] ^ 1;
+            }
         }
 
-        if (m_state.enabled[4]) {
-            /* Vertical asymptote */
-            x = x + m_state.var[4] * x; /* this is the same maths as the last, but with op=0 */
+        for (int event = 0; event < numEvents; ++event) {
+            flags[events[event] - begin] = 1;
         }
 
-        if (m_state.enabled[5]) {
-            /* Vertical asymptote at right of screen */
-            x = (x - 1.0) * m_state.var[5] + 1.0;
+        std::uint32_t dead[CHUNK_SIZE];
+        int count = 0;
+        for (int i = 0; i < n; i += 8) {
+            std::uint64_t word;
+            std::memcpy(&word, flags + i, sizeof(word));
+            if (word) {
+                for (int j = i; j < i + 8; ++j) {
+                    dead[count] = begin + j;
+                    count += flags[j];
+                }
+            }
         }
 
-        /* Splitting (whirlwind effect): */
-        auto num_splits = [this]() { return 2 + static_cast<int>(std::fabs(this->m_state.var[0]) * 1000); };
-        auto thru = [this, i](int splits) {
-            return static_cast<float>(
-                       static_cast<int>(splits * static_cast<float>(i) / static_cast<float>(this->m_state.numPoints))) /
-                   static_cast<float>(splits - 1);
-        };
+        respawn(dead, count);
+    }
 
-        if (m_state.enabled[8]) {
-            x = x + 0.5 * m_state.var[8] * (-1.0 + 2.0 * thru(num_splits()));
-        }
+    // Only the first color change event of the chunk can win.
+    std::uint32_t candidate;
+    return sampleEvents(m_random, m_frame, begin, end, COLOR_GAP, COLOR_PROBABILITY, &candidate, 1) ? candidate : -1;
+}
 
-        if (m_state.enabled[9]) {
-            y = y + 0.5 * m_state.var[9] * (-1.0 + 2.0 * thru(num_splits()));
+//--------------------------------------------------------------------
+int Particles::sampleEvents(const Utils::CounterNumberGenerator& random, const std::uint64_t frame, const int begin,
+                            const int end, const std::uint32_t slot, const double probability, std::uint32_t* events,
+                            const int maxEvents)
+{
+    // The number of particles between two events follows a geometric distribution, floor(log(u) / log(1-p)) with
+    // u uniform in (0,1]. The draws come from the stream of the first particle, one slot per gap.
+    const double scale = 1.0 / std::log1p(-probability);
+
+    int count = 0;
+    double next = begin;
+    for (std::uint32_t draw = slot; count < maxEvents; ++draw) {
+        const double u = (1.0 - random.get(frame, begin, draw)) * 0.5;
+        next += std::floor(std::log(u) * scale);
+        if (next >= end) {
+            break;
         }
 
-        /* Waves */
-        if (m_state.enabled[10]) {
-            y = y + 0.4 * m_state.var[10] * std::sin(300.0 * m_state.var[12] * x + 600.0 * m_state.var[11]);
-        }
+        events[count++] = static_cast<std::uint32_t>(next);
+        next += 1;
+    }
+
+    return count;
+}
+
+//--------------------------------------------------------------------
+void Particles::setIsa(const Kernels::Isa isa)
+{
+    m_isa = isa;
+}
+
+//--------------------------------------------------------------------
+void Particles::setThreads(const unsigned int threads)
+{
+    m_pool = std::make_unique<ThreadPool>(threads);
+}
+
+//--------------------------------------------------------------------
+void Particles::fillPositions(float* data) const
+{
+    // Local bounds and pointers, the stores could alias the members otherwise and the loops wouldn't vectorize.
+    const int numPoints = m_state.numPoints;
+    const float* const x = m_x.data();
+    const float* const y = m_y.data();
+
+    for (int i = 0; i < numPoints; ++i) {
+        data[2 * i] = x[i];
+        data[2 * i + 1] = y[i];
+    }
+}
+
+//--------------------------------------------------------------------
+void Particles::fillPackedPositions(std::uint32_t* data) const
+{
+    const int numPoints = m_state.numPoints;
+    const float* const x = m_x.data();
+    const float* const y = m_y.data();
+
+    for (int i = 0; i < numPoints; ++i) {
+        data[i] = packPosition(x[i], y[i]);
+    }
+}
+
+//--------------------------------------------------------------------
+void Particles::fillAttributes(float* data, const Range& range) const
+{
+    const int count = range.count;
+    const float* const color = m_color.data() + 4 * range.first;
+    const float* const width = m_width.data() + range.first;
+    const std::uint32_t* const birth = m_birth.data() + range.first;
+
+    for (int i = 0; i < count; ++i) {
+        data[6 * i] = color[4 * i];
+        data[6 * i + 1] = color[4 * i + 1];
+        data[6 * i + 2] = color[4 * i + 2];
+        data[6 * i + 3] = color[4 * i + 3];
+        data[6 * i + 4] = width[i];
+        data[6 * i + 5] = birth[i];
+    }
+}
+
+//--------------------------------------------------------------------
+void Particles::fillPackedAttributes(std::uint32_t* data, const Range& range) const
+{
+    const int count = range.count;
+    const float* const color = m_color.data() + 4 * range.first;
+    const float* const width = m_width.data() + range.first;
+    const std::uint32_t* const birth = m_birth.data() + range.first;
+
+    auto packWidth = [](const float value) {
+        return static_cast<std::uint32_t>(static_cast<int>(value * PACKED_WIDTH_UNITS + .5f));
+    };
+
+    for (int i = 0; i < count; ++i) {
+        data[2 * i] = packColor(color + 4 * i);
+        data[2 * i + 1] = packWidth(width[i]) | (birth[i] << 8);
+    }
+}
+
+//--------------------------------------------------------------------
+void Particles::markChanged(const std::uint32_t idx)
+{
+    const auto chunk = idx / CHUNK_SIZE;
+    if (m_chunkChanged[chunk]) {
+        return;
+    }
+
+    auto& changed = m_changed[chunk];
+    if (changed.size() == MAX_CHANGED_PER_CHUNK) {
+        m_chunkChanged[chunk] = 1;
+        changed.clear();
+        return;
+    }
+
+    changed.push_back(idx);
+}
 
-        if (m_state.enabled[13]) {
-            x = x + 0.4 * m_state.var[13] * std::sin(300.0 * m_state.var[15] * y + 600.0 * m_state.var[14]);
+//--------------------------------------------------------------------
+std::vector<Particles::Range> Particles::takeChangedRanges()
+{
+    std::vector<Range> ranges;
+
+    auto add = [&ranges](const std::uint32_t first, const std::uint32_t count) {
+        if (!ranges.empty()) {
+            auto& last = ranges.back();
+            if (first <= last.first + last.count + MIN_RANGE_GAP) {
+                last.count = std::max(last.first + last.count, first + count) - last.first;
+                return;
+            }
         }
 
-        if (x <= -1.f || x >= 1.f || y <= -1.f || y >= 1.f || fabs(x) < .0001 || fabs(y) < .0001) {
-            // If moved off screen or too centered to move, create a new one.
-            reset(i);
+        ranges.push_back(Range{first, count});
+    };
+
+    for (std::size_t chunk = 0; chunk < m_changed.size(); ++chunk) {
+        auto& changed = m_changed[chunk];
+
+        if (m_chunkChanged[chunk]) {
+            const auto begin = static_cast<std::uint32_t>(chunk * CHUNK_SIZE);
+            const auto end = std::min(begin + CHUNK_SIZE, static_cast<std::uint32_t>(m_state.numPoints));
+            add(begin, end - begin);
+            m_chunkChanged[chunk] = 0;
         } else {
-            if (m_generator->get() > 0.995) {
-                reset(i);
-            } else {
-                pos->x = x;
-                pos->y = y;
+            // Respawns are marked in index order, the color change can be anywhere.
+            std::sort(changed.begin(), changed.end());
+            for (const auto idx : changed) {
+                add(idx, 1);
             }
         }
 
-        if (!m_state.changedColor && (m_generator->get() > 0.75)) {
-            const Utils::hsv hsvColor(m_state.hue, 0.6 + 0.4 * m_generator->get(), 0.6 + 0.4 * m_generator->get());
+        changed.clear();
+    }
 
-            // Change one of the allocated colours to something near the current hue.
-            // By changing a random colour, we sometimes get a tight colour spread, sometime a diverse one.
-            const auto rgbColor = Utils::hsv2rgb(hsvColor);
-            pos->r = rgbColor.r;
-            pos->g = rgbColor.g;
-            pos->b = rgbColor.b;
-            pos->a = 1.f;
+    if (ranges.size() > MAX_CHANGED_RANGES) {
+        // Merge the ranges separated by the smallest gaps, uploading the particles in between is cheaper.
+        std::vector<std::uint32_t> gaps(ranges.size() - 1);
+        for (std::size_t i = 0; i < gaps.size(); ++i) {
+            gaps[i] = ranges[i + 1].first - (ranges[i].first + ranges[i].count);
+        }
 
-            m_state.hue = m_state.hue + 0.5 + m_generator->get() * 9.0;
-            if (m_state.hue < 0) {
-                m_state.hue += 360;
-            }
-            if (m_state.hue >= 360) {
-                m_state.hue -= 360;
+        auto sorted = gaps;
+        const auto merges = ranges.size() - MAX_CHANGED_RANGES;
+        std::nth_element(sorted.begin(), sorted.begin() + merges - 1, sorted.end());
+        const auto threshold = sorted[merges - 1];
+        auto equalMerges = merges - std::count_if(gaps.cbegin(), gaps.cend(), [threshold](const std::uint32_t gap) {
+                               return gap < threshold;
+                           });
+
+        std::vector<Range> merged{ranges.front()};
+        for (std::size_t i = 1; i < ranges.size(); ++i) {
+            const auto gap = gaps[i - 1];
+            if (gap < threshold || (gap == threshold && equalMerges > 0)) {
+                equalMerges -= (gap == threshold);
+                merged.back().count = ranges[i].first + ranges[i].count - merged.back().first;
+            } else {
+                merged.push_back(ranges[i]);
             }
-
-            m_state.changedColor = true;
         }
+
+        ranges.swap(merged);
     }
+
+    return ranges;
 }
 
 //--------------------------------------------------------------------
 void Particles::init()
 {
-    const int multiplier = m_config.show_trails ? 2 : 1;
-    m_buffer = std::vector<float>((multiplier * m_state.numPoints * sizeof(Particle)), 0);
+    const auto numPoints = static_cast<std::size_t>(m_state.numPoints);
+    const auto numChunks = (numPoints + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    m_changed.assign(numChunks, std::vector<std::uint32_t>());
+    m_chunkChanged.assign(numChunks, 0);
 
-    std::vector<size_t> index[m_state.numPoints];
-    std::iota(index->begin(), index->end(), 0);
+    m_x.assign(numPoints, 0.f);
+    m_y.assign(numPoints, 0.f);
+    m_color.assign(4 * numPoints, 0.f);
+    m_width.assign(numPoints, 0.f);
+    m_birth.assign(numPoints, 0);
 
-    auto resetBuffer = [&](const size_t pos) { reset(pos); };
-    std::for_each(index->cbegin(), index->cend(), resetBuffer);
+    for (int i = 0; i < m_state.numPoints; ++i) {
+        reset(i);
+    }
+
+    // The initial positions are never drawn, the trails start with the positions of the first frame.
+    std::fill(m_birth.begin(), m_birth.end(), 1);
+
+    for (auto& changed : m_changed) {
+        changed.clear();
+    }
+    std::fill(m_chunkChanged.begin(), m_chunkChanged.end(), 1);
 }
 
 //--------------------------------------------------------------------
-void Particles::reset(const int idx)
+void Particles::respawn(const std::uint32_t* indexes, const int n)
 {
-    const int multiplier = m_config.show_trails ? 2 : 1;
-    const auto pos = reinterpret_cast<Particle*>(m_buffer.data()) + (idx * multiplier);
+    static const int BATCH = 256;
 
-    memset(pos, 0, multiplier * sizeof(Particle));
-    pos->x = m_generator->get();
-    pos->y = m_generator->get();
+    for (int first = 0; first < n; first += BATCH) {
+        const auto count = std::min(BATCH, n - first);
+        const auto batch = indexes + first;
 
-    Utils::hsv hsvColor((m_generator->get() + 1.0) * 180.0, 0.6 + 0.4 * m_generator->get(),
-                        0.6 + 0.4 * m_generator->get());
-    const auto rgbColor = Utils::hsv2rgb(hsvColor);
-    pos->r = rgbColor.r;
-    pos->g = rgbColor.g;
-    pos->b = rgbColor.b;
-    pos->a = 1.f;
+        // Slots are used as indexes, the per frame rolls aren't needed.
+        float draws[RESET_W + 1][BATCH];
+        for (std::uint32_t slot = RESET_X; slot <= RESET_W; ++slot) {
+            m_random.gather(m_frame, batch, slot, draws[slot], count);
+        }
+
+        Utils::hsv hsvColors[BATCH];
+        for (int i = 0; i < count; ++i) {
+            hsvColors[i] = Utils::hsv((draws[RESET_H][i] + 1.0) * 180.0, 0.6 + 0.4 * draws[RESET_S][i],
+                                      0.6 + 0.4 * draws[RESET_V][i]);
+        }
 
-    pos->w = m_config.point_size + (m_generator->get() + 1);
+        Utils::rgb rgbColors[BATCH];
+        Utils::hsv2rgb(hsvColors, rgbColors, count);
 
-    if (m_config.show_trails) {
-        memcpy(pos + 1, pos, sizeof(Particle));
+        for (int i = 0; i < count; ++i) {
+            const auto idx = batch[i];
+            m_x[idx] = draws[RESET_X][i];
+            m_y[idx] = draws[RESET_Y][i];
+            toAreas(m_x[idx], m_y[idx]);
+
+            float* color = m_color.data() + 4 * idx;
+            color[0] = rgbColors[i].r;
+            color[1] = rgbColors[i].g;
+            color[2] = rgbColors[i].b;
+            color[3] = 1.f;
+
+            m_width[idx] = m_config.point_size + (draws[RESET_W][i] + 1);
+            m_birth[idx] = m_frame % BIRTH_FRAMES;
+            markChanged(idx);
+        }
+    }
+}
+
+//--------------------------------------------------------------------
+void Particles::setInlineRespawn(const bool value)
+{
+    m_inlineRespawn = value;
+}
+
+//--------------------------------------------------------------------
+void Particles::setAreas(const std::vector<Area>& areas)
+{
+    m_areas = areas;
+    m_areaEnds.clear();
+
+    double total = 0;
+    for (const auto& area : m_areas) {
+        total += static_cast<double>(area.right - area.left) * (area.top - area.bottom);
+    }
+
+    double end = 0;
+    for (const auto& area : m_areas) {
+        end += static_cast<double>(area.right - area.left) * (area.top - area.bottom);
+        m_areaEnds.push_back(end / total);
+    }
+
+    init();
+}
+
+//--------------------------------------------------------------------
+void Particles::toAreas(float& x, float& y) const
+{
+    if (m_areas.empty()) {
+        return;
     }
-};
+
+    // The position of x in the cumulative sizes picks the area, the remainder is uniform in it.
+    const float u = (x + 1.f) * 0.5f;
+    std::size_t i = 0;
+    while (i + 1 < m_areaEnds.size() && u >= m_areaEnds[i]) {
+        ++i;
+    }
+
+    const float begin = i == 0 ? 0.f : m_areaEnds[i - 1];
+    const float t = std::min(std::max((u - begin) / (m_areaEnds[i] - begin), 0.f), 1.f);
+    const auto& area = m_areas[i];
+    x = area.left + t * (area.right - area.left);
+    y = area.bottom + (y + 1.f) * 0.5f * (area.top - area.bottom);
+}
+
+//--------------------------------------------------------------------
+void Particles::reset(const int idx)
+{
+    // Slots are used as indexes, the per frame rolls aren't needed.
+    float draws[RESET_W + 1];
+    for (std::uint32_t slot = RESET_X; slot <= RESET_W; ++slot) {
+        draws[slot] = m_random.get(m_frame, idx, slot);
+    }
+
+    m_x[idx] = draws[RESET_X];
+    m_y[idx] = draws[RESET_Y];
+    toAreas(m_x[idx], m_y[idx]);
+
+    Utils::hsv hsvColor((draws[RESET_H] + 1.0) * 180.0, 0.6 + 0.4 * draws[RESET_S], 0.6 + 0.4 * draws[RESET_V]);
+    const auto rgbColor = Utils::hsv2rgb(hsvColor);
+    float* color = m_color.data() + 4 * idx;
+    color[0] = rgbColor.r;
+    color[1] = rgbColor.g;
+    color[2] = rgbColor.b;
+    color[3] = 1.f;
+
+    m_width[idx] = m_config.point_size + (draws[RESET_W] + 1);
+    m_birth[idx] = m_frame % BIRTH_FRAMES;
+    markChanged(idx);
+};
\ No newline at end of file
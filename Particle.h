@@ -21,8 +21,12 @@
 #define PARTICLE_H_
 
 #include <Utils.h>
+#include <Kernels.h>
+#include <ThreadPool.h>
 
 // C++
+#include <cstdint>
+#include <memory>
 #include <vector>
 #include <math.h>
 
@@ -33,20 +37,8 @@ namespace Utils
     class NumberGenerator;
 }
 
-/** \struct Particle
- * \brief Particle components.
- *
- */
-struct __attribute__((__packed__)) Particle
-{
-    float x; /** x posision.          */
-    float y; /** y position.          */
-    float r; /** red component.       */
-    float g; /** green component.     */
-    float b; /** blue component.      */
-    float a; /** alpha component.     */
-    float w; /** particle/trail width */
-};
+constexpr float PACKED_WIDTH_UNITS = 32.f;       /** steps per pixel of the packed widths.          */
+constexpr std::uint32_t BIRTH_FRAMES = 1u << 24; /** the birth frames of the particles wrap around. */
 
 /** \class Particle
  * \brief Implements a particle in the QGraphicsView
@@ -55,6 +47,28 @@ struct __attribute__((__packed__)) Particle
 class Particles
 {
   public:
+    /** \struct Range
+     * \brief Range of consecutive particle indexes.
+     *
+     */
+    struct Range
+    {
+        std::uint32_t first; /** first particle index. */
+        std::uint32_t count; /** number of particles.  */
+    };
+
+    /** \struct Area
+     * \brief Rectangle of the simulation space, in normalized device coordinates.
+     *
+     */
+    struct Area
+    {
+        float left;   /** minimum x. */
+        float bottom; /** minimum y. */
+        float right;  /** maximum x. */
+        float top;    /** maximum y. */
+    };
+
     /** \brief Particle class constructor.
      * \param[in] state application state.
      * \param[in] generator random number generator.
@@ -76,30 +90,216 @@ class Particles
      */
     void advance();
 
-    /** \brief Returns the buffer pointer.
+    /** \brief Sets the instruction set of the advance kernel. By default the widest one supported by the CPU
+     * is used, SCALAR selects the double precision reference implementation.
+     * \param[in] isa Instruction set.
      *
      */
-    inline const float* buffer() const
+    void setIsa(const Kernels::Isa isa);
+
+    /** \brief Sets the number of threads used to advance the particles. The result doesn't depend on it.
+     * \param[in] threads number of threads, 0 to use all the hardware threads.
+     *
+     */
+    void setThreads(const unsigned int threads);
+
+    /** \brief Returns the threads that advance the particles, shared with their renderer so the CPU isn't
+     * oversubscribed. Replaced by setThreads().
+     *
+     */
+    inline ThreadPool& pool()
     {
-        return m_buffer.data();
+        return *m_pool;
     }
 
+    /** \brief Sets the respawn path. By default the particles to respawn are collected in a list and reinitialized
+     * in bulk after advancing the chunk, the inline path resets them one by one in the advance loop. Both give the
+     * same bits, the inline path is kept for comparison.
+     * \param[in] value true to respawn inline and false otherwise.
+     *
+     */
+    void setInlineRespawn(const bool value);
+
+    /** \brief Sets the visible areas of the simulation space and reinitializes the particles. The particles are
+     * spawned uniformly over the areas and respawn when they leave them. By default the whole space is visible.
+     * \param[in] areas non overlapping areas, empty for the whole space.
+     *
+     */
+    void setAreas(const std::vector<Area>& areas);
+
+    /** \brief Resets the values of the given point index. The new values only depend on the seed, the
+     * current frame and the index.
+     * \param[in] idx point index.
+     *
+     */
+    void reset(const int idx);
+
+    /** \brief Reinitializes the given points, same values as reset() in batches.
+     * \param[in] indexes point indexes.
+     * \param[in] n number of points.
+     *
+     */
+    void respawn(const std::uint32_t* indexes, const int n);
+
+    /** \brief Returns the instruction set of the advance kernel.
+     *
+     */
+    inline Kernels::Isa isa() const
+    {
+        return m_isa;
+    }
+
+    /** \brief Returns the number of advanced frames.
+     *
+     */
+    inline std::uint64_t frame() const
+    {
+        return m_frame;
+    }
+
+    /** \brief Writes the positions to the given buffer, x and y per particle. The trails are drawn from the
+     * positions of the previous frames, kept by the renderer.
+     * \param[out] data buffer of at least positionsSize() floats.
+     *
+     */
+    void fillPositions(float* data) const;
+
+    /** \brief Writes the quantized positions to the given buffer, one word per particle with x and y as
+     * normalized 16 bit integers in little endian order.
+     * \param[out] data buffer of at least positionsSize() / 2 words.
+     *
+     */
+    void fillPackedPositions(std::uint32_t* data) const;
+
+    /** \brief Returns the size in floats of the positions buffer.
+     *
+     */
+    inline std::size_t positionsSize() const
+    {
+        return m_x.size() * 2;
+    }
+
+    /** \brief Writes the attributes of the given particles to the given buffer, r, g, b, a, width and birth
+     * frame per particle. The birth frame is the frame of the last respawn modulo BIRTH_FRAMES, positions of
+     * older frames don't belong to the trail of the particle.
+     * \param[out] data buffer of at least attributesSize() floats, the range is written from the start.
+     * \param[in] range particles to write.
+     *
+     */
+    void fillAttributes(float* data, const Range& range) const;
+
+    /** \brief Writes the quantized attributes of the given particles to the given buffer, two words per
+     * particle: the color as normalized 8 bit rgba, then the width in 1/PACKED_WIDTH_UNITS pixels in the low byte
+     * and the birth frame in the upper three bytes, in little endian order.
+     * \param[out] data buffer of at least packedAttributesSize() words, the range is written from the start.
+     * \param[in] range particles to write.
+     *
+     */
+    void fillPackedAttributes(std::uint32_t* data, const Range& range) const;
+
+    /** \brief Returns the size in floats of the attributes buffer.
+     *
+     */
+    inline std::size_t attributesSize() const
+    {
+        return m_x.size() * 6;
+    }
+
+    /** \brief Returns the size in words of the quantized attributes buffer.
+     *
+     */
+    inline std::size_t packedAttributesSize() const
+    {
+        return m_x.size() * 2;
+    }
+
+    /** \brief Returns the sorted ranges of particles whose color or width changed since the last call, coalesced
+     * into a few ranges, and forgets them. After construction all the particles have changed.
+     *
+     */
+    std::vector<Range> takeChangedRanges();
+
+    /** \brief Samples the indexes of the particles in [begin, end) that get a random event of the given probability
+     * in the given frame, skipping the ones that don't. The gaps between events are drawn from the stream of the
+     * first particle. Returns the number of events.
+     * \param[in] random per particle random numbers in [-1,1].
+     * \param[in] frame frame number.
+     * \param[in] begin index of the first particle.
+     * \param[in] end index past the last particle.
+     * \param[in] slot first random slot of the gaps between events.
+     * \param[in] probability probability of the event for a particle.
+     * \param[out] events indexes of the particles in increasing order.
+     * \param[in] maxEvents maximum number of events to sample.
+     *
+     */
+    static int sampleEvents(const Utils::CounterNumberGenerator& random, const std::uint64_t frame, const int begin,
+                            const int end, const std::uint32_t slot, const double probability, std::uint32_t* events,
+                            const int maxEvents);
+
   private:
     /** \brief Initializes the particle container with random numbers.
      *
      */
     void init();
 
-    /** \brief Resets the values of the given point index.
+    /** \brief Advances the particles of the given chunk and returns the index of the particle that won the color
+     * change roll in the chunk, or -1 if none.
+     * \param[in] chunk chunk index.
+     * \param[in] fields force field parameters of the frame.
+     * \param[in] kernel force fields kernel of the frame.
+     *
+     */
+    int advanceChunk(const int chunk, const Kernels::Fields& fields, const Kernels::Advance kernel);
+
+    /** \brief Records that the color or width of the given particle changed. Only touches the list of the chunk
+     * of the particle, so chunks can be marked in parallel.
      * \param[in] idx point index.
      *
      */
-    void reset(const int idx);
+    void markChanged(const std::uint32_t idx);
+
+    /** \brief Moves a position drawn uniformly in the simulation space to the visible areas, keeping it uniform
+     * over their union. The area is chosen by the x coordinate, weighted by the size of the areas.
+     * \param[inout] x x coordinate in [-1,1].
+     * \param[inout] y y coordinate in [-1,1].
+     *
+     */
+    void toAreas(float& x, float& y) const;
+
+    /** \brief Returns true if the given position is inside a visible area.
+     * \param[in] x x coordinate.
+     * \param[in] y y coordinate.
+     *
+     */
+    inline bool visible(const float x, const float y) const
+    {
+        bool inside = false;
+        for (const auto& area : m_areas) {
+            inside |= (x > area.left) & (x < area.right) & (y > area.bottom) & (y < area.top);
+        }
+        return inside;
+    }
+
+    static constexpr int CHUNK_SIZE = 8192; /** particles per chunk. */
+
+    State& m_state;                         /** application state.                                 */
+    Utils::NumberGenerator* m_generator;    /** random number generator in [-1.1].                 */
+    const Utils::Configuration& m_config;   /** application configuration reference.               */
+    Utils::AlignedVector<float> m_x;        /** x positions.                                       */
+    Utils::AlignedVector<float> m_y;        /** y positions.                                       */
+    Utils::AlignedVector<float> m_color;    /** rgba colors, four consecutive values per particle. */
+    Utils::AlignedVector<float> m_width;    /** particle/trail widths.                             */
+    std::vector<std::uint32_t> m_birth;     /** frame of the last respawn modulo BIRTH_FRAMES.     */
+    bool m_inlineRespawn;                   /** true to reset the particles in the advance loop.   */
+    Kernels::Isa m_isa;                     /** instruction set of the advance kernel.             */
+    std::unique_ptr<ThreadPool> m_pool;     /** threads that advance the chunks.                   */
+    Utils::CounterNumberGenerator m_random; /** per particle random numbers in [-1,1].             */
+    std::uint64_t m_frame;                  /** number of advanced frames.                         */
+    std::vector<Area> m_areas;              /** visible areas, empty if all the space is visible.  */
+    std::vector<float> m_areaEnds;          /** cumulative size fractions of the areas.            */
 
-    State& m_state;                       /** application state.                   */
-    Utils::NumberGenerator* m_generator;  /** random number generator in [-1.1].   */
-    std::vector<float> m_buffer;          /** data buffer.                         */
-    const Utils::Configuration& m_config; /** application configuration reference. */
+    std::vector<std::vector<std::uint32_t>> m_changed; /** indexes of the changed particles, per chunk.        */
+    std::vector<std::uint8_t> m_chunkChanged;          /** non zero if all the particles of a chunk changed. */
 };
 
 #endif // PARTICLE_H_
@@ -0,0 +1,291 @@
+/*
+ File: PlatformUtils.cpp
+ Created on: 17/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <PlatformUtils.h>
+
+// GLFW
+#include <external/gl_loader.h>
+#include <GLFW/glfw3.h>
+
+// C++
+#include <windows.h>
+#include <winreg.h>
+#include <iostream>
+#include <string>
+#include <winuser.h>
+#include <cassert>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+LPCSTR KEY_BASEKEY = "Software\\Felix de las Pozas Alvarez\\WhirlWindWarp";
+LPCSTR KEY_MOTIONBLUR = "MotionBlur";
+LPCSTR KEY_ANTIALIAS = "Antialias";
+LPCSTR KEY_POINTSIZE = "PointSize";
+LPCSTR KEY_SHOWTRAIL = "ShowTrail";
+LPCSTR KEY_PIXELSPERPOINT = "PixelsPerPoint";
+LPCSTR KEY_PACKEDVERTICES = "PackedVertices";
+LPCSTR KEY_INSTANCEDTRAILS = "InstancedTrails";
+LPCSTR KEY_TRAILLENGTH = "TrailLength";
+LPCSTR KEY_BLURSCALE = "BlurScale";
+
+//----------------------------------------------------------------------------
+void Utils::loadConfiguration(Configuration& config)
+{
+    HKEY default_key;
+    auto status = RegOpenKeyExA(HKEY_CURRENT_USER, KEY_BASEKEY, 0, KEY_QUERY_VALUE, &default_key);
+
+    if (status == ERROR_SUCCESS) {
+        DWORD dataVal = 0;
+
+        auto readRegistryValue = [&status, &dataVal, &default_key](LPCSTR key) {
+            DWORD size = sizeof(DWORD);
+            return RegGetValueA(default_key, "", key, RRF_RT_DWORD, nullptr, &dataVal, &size);
+        };
+
+        if (ERROR_SUCCESS == readRegistryValue(KEY_MOTIONBLUR)) {
+            config.motion_blur = (dataVal == 0);
+        }
+
+        if (ERROR_SUCCESS == readRegistryValue(KEY_ANTIALIAS)) {
+            config.antialias = (dataVal == 0);
+        }
+
+        if (ERROR_SUCCESS == readRegistryValue(KEY_POINTSIZE)) {
+            config.point_size = dataVal;
+        }
+
+        if (ERROR_SUCCESS == readRegistryValue(KEY_SHOWTRAIL)) {
+            config.show_trails = (dataVal == 0);
+        }
+
+        if (ERROR_SUCCESS == readRegistryValue(KEY_PIXELSPERPOINT)) {
+            config.pixelsPerPoint = dataVal;
+        }
+
+        if (ERROR_SUCCESS == readRegistryValue(KEY_PACKEDVERTICES)) {
+            config.packed_vertices = (dataVal == 0);
+        }
+
+        if (ERROR_SUCCESS == readRegistryValue(KEY_INSTANCEDTRAILS)) {
+            config.instanced_trails = (dataVal == 0);
+        }
+
+        if (ERROR_SUCCESS == readRegistryValue(KEY_TRAILLENGTH)) {
+            config.trail_length = dataVal;
+        }
+
+        if (ERROR_SUCCESS == readRegistryValue(KEY_BLURSCALE)) {
+            config.blur_scale = dataVal;
+        }
+
+        RegCloseKey(default_key);
+    } else {
+        std::cerr << "loadConfiguration: unable to open main key." << std::endl;
+    }
+}
+
+//----------------------------------------------------------------------------
+void Utils::saveConfiguration(const Configuration& config)
+{
+    HKEY default_key;
+    auto status = RegCreateKeyExA(HKEY_CURRENT_USER, KEY_BASEKEY, 0, NULL, REG_OPTION_NON_VOLATILE, KEY_SET_VALUE, NULL,
+                                  &default_key, NULL);
+    if (status == ERROR_SUCCESS) {
+        auto saveRegistryValue = [&status, &default_key](LPCSTR key, DWORD value) {
+            return RegSetValueExA(default_key, key, 0, REG_DWORD, (BYTE*)(&value), sizeof(DWORD));
+        };
+
+        saveRegistryValue(KEY_MOTIONBLUR, config.motion_blur ? 0 : 1);
+        saveRegistryValue(KEY_ANTIALIAS, config.antialias ? 0 : 1);
+        saveRegistryValue(KEY_POINTSIZE, config.point_size);
+        saveRegistryValue(KEY_SHOWTRAIL, config.show_trails ? 0 : 1);
+        saveRegistryValue(KEY_PIXELSPERPOINT, config.pixelsPerPoint);
+        saveRegistryValue(KEY_PACKEDVERTICES, config.packed_vertices ? 0 : 1);
+        saveRegistryValue(KEY_INSTANCEDTRAILS, config.instanced_trails ? 0 : 1);
+        saveRegistryValue(KEY_TRAILLENGTH, config.trail_length);
+        saveRegistryValue(KEY_BLURSCALE, config.blur_scale);
+
+        RegCloseKey(default_key);
+    } else {
+        std::cerr << "saveConfiguration: unable to open main key" << std::endl;
+    }
+}
+
+//----------------------------------------------------------------------------
+void Utils::errorCallback(int error, const char* description)
+{
+    std::cout << "\n--\n" << description << "\n--\n" << std::endl;
+    std::string msg = "Error code: " + std::to_string(error) + "\nDescription: " + description;
+    std::string title = "Error";
+    MessageBoxA(nullptr, msg.c_str(), title.c_str(), MB_OK);
+    std::exit(-1);
+}
+
+//----------------------------------------------------------------------------
+void Utils::glfwKeyCallback(GLFWwindow* window, int, int, int, int)
+{
+    glfwSetWindowShouldClose(window, GLFW_TRUE);
+}
+
+//----------------------------------------------------------------------------
+void Utils::glfwFocusCallback(GLFWwindow *window, int inFocus)
+{
+    if(!inFocus)
+        glfwFocusWindow(window);
+}
+
+//----------------------------------------------------------------------------
+void Utils::glfwMousePosCallback(GLFWwindow* window, double xpos, double ypos)
+{
+    static double x = -1;
+    static double y = -1;
+
+    if (x == -1) {
+        x = xpos;
+    }
+    if (y == -1) {
+        y = ypos;
+    }
+    if (x != xpos || y != ypos) {
+        glfwSetWindowShouldClose(window, GLFW_TRUE);
+    }
+}
+
+//----------------------------------------------------------------------------
+void Utils::glfwMouseButtonCallback(GLFWwindow* window, int, int, int)
+{
+    glfwSetWindowShouldClose(window, GLFW_TRUE);
+}
+
+//----------------------------------------------------------------------------
+GLint Utils::loadShader(const char* source, GLenum type)
+{
+    GLuint shader;
+    shader = glCreateShader(type);
+    glShaderSource(shader, 1, (const GLchar**)&source, nullptr);
+    glCompileShader(shader);
+
+    GLint compiled;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+    if (!compiled) {
+        const std::string shaderType =
+            type == GL_VERTEX_SHADER ? "Vertex" : (type == GL_FRAGMENT_SHADER ? "Fragment" : "Geometry");
+
+        GLint logLen = -1;
+        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLen);
+
+        char* logString = new char[logLen];
+        memset(logString, 0, logLen);
+        glGetShaderInfoLog(shader, logLen, nullptr, logString);
+
+        const std::string errorString =
+            shaderType + std::string(" shader compilation failed : ") + (logLen > 0 ? logString : "empty");
+        delete[] logString;
+
+        glDeleteShader(shader);
+        errorCallback(EXIT_FAILURE, errorString.c_str());
+    }
+
+    return shader;
+}
+
+//----------------------------------------------------------------------------
+void Utils::initProgram(GL_program& program, attribList attribs)
+{
+    program.program = glCreateProgram();
+
+    if (program.vert != static_cast<unsigned int>(-1)) {
+        glAttachShader(program.program, program.vert);
+    }
+
+    if (program.geom != static_cast<unsigned int>(-1)) {
+        glAttachShader(program.program, program.geom);
+    }
+
+    if (program.frag != static_cast<unsigned int>(-1)) {
+        glAttachShader(program.program, program.frag);
+    }
+
+    for (auto& [pos, attribName] : attribs) {
+        glBindAttribLocation(program.program, pos, attribName.c_str());
+    }
+
+    glLinkProgram(program.program);
+
+    int linked;
+    glGetProgramiv(program.program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        GLint logLen;
+        glGetProgramiv(program.program, GL_INFO_LOG_LENGTH, &logLen);
+
+        char* logString = new char[logLen];
+        memset(logString, 0, logLen);
+        glGetProgramInfoLog(program.program, logLen, NULL, logString);
+        const std::string errorString =
+            std::string("GL program \"") + program.name + "\" link failed: " + (logLen > 0 ? logString : "empty");
+        delete[] logString;
+
+        glDeleteProgram(program.program);
+        errorCallback(EXIT_FAILURE, errorString.c_str());
+    }
+}
+
+//----------------------------------------------------------------------------
+void Utils::saveScreenshotToFile(const std::string& filename, int windowWidth, int windowHeight)
+{
+    const int numberOfPixels = windowWidth * windowHeight * 3;
+    auto pixels = std::make_unique<std::vector<unsigned char>>(numberOfPixels);
+
+    GLint alignment;
+    glGetIntegerv(GL_PACK_ALIGNMENT, &alignment);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadBuffer(GL_FRONT);
+    glReadPixels(0, 0, windowWidth, windowHeight, GL_BGR_EXT, GL_UNSIGNED_BYTE, pixels->data());
+    glReadBuffer(GL_BACK);
+    glPixelStorei(GL_PACK_ALIGNMENT, alignment);
+
+    std::ofstream outputFile(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    short header[] = {0, 2, 0, 0, 0, 0, static_cast<short int>(windowWidth), static_cast<short int>(windowHeight), 24};
+    outputFile.write(reinterpret_cast<const char*>(header), sizeof(header));
+    outputFile.write(reinterpret_cast<const char*>(pixels->data()), numberOfPixels);
+    outputFile.close();
+
+    std::cout << "Finish writing to file: " << filename << std::endl;
+}
+
+//----------------------------------------------------------------------------
+std::wstring Utils::s2ws(const std::string& str)
+{
+    int size_needed = MultiByteToWideChar(CP_UTF8, 0, &str[0], (int)str.size(), NULL, 0);
+    std::wstring wstrTo(size_needed, 0);
+    MultiByteToWideChar(CP_UTF8, 0, &str[0], (int)str.size(), &wstrTo[0], size_needed);
+    return wstrTo;
+}
+
+//----------------------------------------------------------------------------
+std::string Utils::ws2s(const std::wstring& wstr)
+{
+    int size_needed = WideCharToMultiByte(CP_UTF8, 0, &wstr[0], (int)wstr.size(), NULL, 0, NULL, NULL);
+    std::string strTo(size_needed, 0);
+    WideCharToMultiByte(CP_UTF8, 0, &wstr[0], (int)wstr.size(), &strTo[0], size_needed, NULL, NULL);
+    return strTo;
+}
@@ -0,0 +1,145 @@
+/*
+ File: PlatformUtils.h
+ Created on: 17/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _PLATFORM_UTILS_H_
+#define _PLATFORM_UTILS_H_
+
+// Project
+#include <Utils.h>
+
+// OpenGL
+#include <GL/gl.h>
+
+// C++
+#include <list>
+#include <string>
+
+struct GLFWwindow;
+
+/** \brief Windows, registry and OpenGL helpers of the screensaver. The simulation only needs the portable ones in
+ * Utils.h.
+ *
+ */
+namespace Utils
+{
+    /** \struct GL_program
+     * \brief Contains a gl program. 
+     *
+     */
+    struct GL_program
+    {
+        std::string name;
+        unsigned int vert;
+        unsigned int geom;
+        unsigned int frag;
+        unsigned int program;
+
+        /** \brief GL_program struct constructor.
+         * \param[in] n Program name.
+         */
+        GL_program(const std::string& n) :
+            name{n},
+            vert{static_cast<unsigned int>(-1)},
+            geom{static_cast<unsigned int>(-1)},
+            frag{static_cast<unsigned int>(-1)},
+            program{static_cast<unsigned int>(-1)} {};
+    };
+
+    /** \brief Loads the application configuration from the windows registry. 
+     * \param[out] config Configuration struct reference. 
+     *
+     */
+    void loadConfiguration(Configuration& config);
+
+    /** \brief Saves the application configuration to the windows registry. 
+     * \param[in] config Configuration struct reference. 
+     *
+     */
+    void saveConfiguration(const Configuration& config);
+
+    /** \brief Helper method to convert a string to a wide-char string.
+     * \param[in] str String reference. 
+     *
+     */
+    std::wstring s2ws(const std::string& str);
+
+    /** \brief Helper method to convert a wide-char string to a UTF-8 string.
+     * \param[in] wstr Wide-char string reference.
+     *
+     */
+    std::string ws2s(const std::wstring& wstr);
+
+    /** \brief  Error callback for errors.
+     * \param error Error code.
+     * \param description Error description.
+     *
+     */
+    void errorCallback(int error, const char* description);
+
+    /** \brief Key callback for glfw key processing.
+     * \param[in] window GLFW window pointer.
+     *
+     */
+    void glfwKeyCallback(GLFWwindow* window, int /* key */, int /* scancode */, int /* action */, int /* mods */);
+
+    /** \brief Mouse movement callback for glfw.
+     * \param[in] window GLFW window pointer.
+     *
+     */
+    void glfwMousePosCallback(GLFWwindow* window, double /* xpos */, double /* ypos */);
+
+    /** \brief Mouse buttons callback for glfw.
+    * \param[in] window GLFW window pointer.
+    *
+    */
+    void glfwMouseButtonCallback(GLFWwindow* window, int /* button */, int /* action */, int /* mods */);
+
+    /** void \brief GLFW focus callback.
+    * \param[in] window GLFW window pointer.
+    * \param[in] inFocus True if the window is in focus, and false otherwise. 
+    *
+    */
+    void glfwFocusCallback(GLFWwindow *window, int inFocus);
+
+    /** \brief Helper method to load the shader and check for errors.
+     * \param[in] source Shader source code.
+     * \param[in] type Shader type: vertex, fragment.
+     *
+     */
+    GLint loadShader(const char* source, GLenum type);
+
+    // List of attribute bind positions and names.
+    using attribList = std::list<std::pair<GLuint, const std::string>>;
+
+    /** \brief Helper method to compile the program and check for errors.
+     * \param[inout] program GL program struct reference.
+     */
+    void initProgram(GL_program& program, attribList attribs = attribList());
+
+    /** \brief Helper method to save the current framebuffer to a TGA file. Reads synchronously, use a FrameCapture
+     * to record several frames.
+     * \param[in] filename TGA file name.
+     * \param[in] windowWidth Width in pixels of the framebuffer.
+     * \param[in] windowHeight Height in pixels of the framebuffer. 
+     *
+     */
+    void saveScreenshotToFile(const std::string& filename, int windowWidth, int windowHeight);
+} // namespace Utils
+
+#endif // _PLATFORM_UTILS_H_
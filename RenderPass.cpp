@@ -0,0 +1,288 @@
+/*
+ File: RenderPass.cpp
+ Created on: 17/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <RenderPass.h>
+#include <external/gl_loader.h>
+
+// C++
+#include <cassert>
+
+namespace
+{
+    const GLuint UNKNOWN = static_cast<GLuint>(-1); /** binding not known by the cache. */
+} // namespace
+
+//--------------------------------------------------------------------
+GLState::GLState() :
+    m_program{UNKNOWN},
+    m_vao{UNKNOWN},
+    m_arrayBuffer{UNKNOWN},
+    m_framebuffer{UNKNOWN},
+    m_texture{UNKNOWN},
+    m_viewport{-1, -1},
+    m_scissor{-1, -1, -1, -1},
+    m_calls{0},
+    m_frameCalls{0}
+{
+}
+
+//--------------------------------------------------------------------
+void GLState::useProgram(const GLuint program)
+{
+    if (m_program != program) {
+        glUseProgram(program);
+        m_program = program;
+        ++m_calls;
+    }
+}
+
+//--------------------------------------------------------------------
+void GLState::bindVertexArray(const GLuint vao)
+{
+    if (m_vao != vao) {
+        glBindVertexArray(vao);
+        m_vao = vao;
+        ++m_calls;
+    }
+}
+
+//--------------------------------------------------------------------
+void GLState::bindArrayBuffer(const GLuint buffer)
+{
+    if (m_arrayBuffer != buffer) {
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        m_arrayBuffer = buffer;
+        ++m_calls;
+    }
+}
+
+//--------------------------------------------------------------------
+void GLState::bindFramebuffer(const GLuint framebuffer)
+{
+    if (m_framebuffer != framebuffer) {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        m_framebuffer = framebuffer;
+        ++m_calls;
+    }
+}
+
+//--------------------------------------------------------------------
+void GLState::bindTexture(const GLuint texture)
+{
+    if (m_texture != texture) {
+        glBindTexture(GL_TEXTURE_2D, texture);
+        m_texture = texture;
+        ++m_calls;
+    }
+}
+
+//--------------------------------------------------------------------
+void GLState::setViewport(const GLsizei width, const GLsizei height)
+{
+    if (m_viewport[0] != width || m_viewport[1] != height) {
+        glViewport(0, 0, width, height);
+        m_viewport = {width, height};
+        ++m_calls;
+    }
+}
+
+//--------------------------------------------------------------------
+void GLState::setScissor(const GLint x, const GLint y, const GLsizei width, const GLsizei height)
+{
+    const std::array<GLint, 4> scissor{x, y, width, height};
+    if (m_scissor != scissor) {
+        glScissor(x, y, width, height);
+        m_scissor = scissor;
+        ++m_calls;
+    }
+}
+
+//--------------------------------------------------------------------
+void GLState::setEnabled(const GLenum capability, const bool enabled)
+{
+    const auto it = m_enabled.find(capability);
+    if (it != m_enabled.end() && it->second == enabled) {
+        return;
+    }
+
+    if (enabled) {
+        glEnable(capability);
+    } else {
+        glDisable(capability);
+    }
+    m_enabled[capability] = enabled;
+    ++m_calls;
+}
+
+//--------------------------------------------------------------------
+void GLState::bufferSubData(const GLuint buffer, const std::size_t offset, const std::size_t size, const void* data)
+{
+    bindArrayBuffer(buffer);
+    glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
+    ++m_calls;
+}
+
+//--------------------------------------------------------------------
+void GLState::clear(const GLbitfield mask)
+{
+    glClear(mask);
+    ++m_calls;
+}
+
+//--------------------------------------------------------------------
+void GLState::endFrame()
+{
+    m_frameCalls = m_calls;
+    m_calls = 0;
+}
+
+//--------------------------------------------------------------------
+RenderPass::RenderPass(GLState& state, const GLuint program, const GLenum mode, const int variants) :
+    m_state{state},
+    m_program{program},
+    m_mode{mode},
+    m_vaos(variants, 0),
+    m_indexed{false}
+{
+    glGenVertexArrays(variants, m_vaos.data());
+}
+
+//--------------------------------------------------------------------
+RenderPass::~RenderPass()
+{
+    // Deleting the bound vertex array reverts the binding to 0, forget it so the next bind isn't skipped.
+    m_state.bindVertexArray(0);
+    glDeleteVertexArrays(m_vaos.size(), m_vaos.data());
+}
+
+//--------------------------------------------------------------------
+void RenderPass::setAttribute(const int variant, const GLuint index, const GLuint buffer, const GLint size,
+                              const GLenum type, const GLboolean normalized, const GLsizei stride,
+                              const std::size_t offset, const GLuint divisor)
+{
+    assert(variant >= 0 && variant < static_cast<int>(m_vaos.size()));
+
+    m_state.bindVertexArray(m_vaos[variant]);
+    m_state.bindArrayBuffer(buffer);
+    glVertexAttribPointer(index, size, type, normalized, stride, reinterpret_cast<const void*>(offset));
+    glEnableVertexAttribArray(index);
+    m_state.count(2);
+
+    if (divisor != 0) {
+        glVertexAttribDivisor(index, divisor);
+        m_state.count();
+    }
+}
+
+//--------------------------------------------------------------------
+void RenderPass::setElements(const GLuint buffer)
+{
+    for (const auto vao : m_vaos) {
+        m_state.bindVertexArray(vao);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);
+        m_state.count();
+    }
+
+    m_indexed = true;
+}
+
+//--------------------------------------------------------------------
+int RenderPass::uniform(const std::string& name)
+{
+    const auto it = m_handles.find(name);
+    if (it != m_handles.end()) {
+        return it->second;
+    }
+
+    const GLint location = glGetUniformLocation(m_program, name.c_str());
+    m_state.count();
+
+    const int handle = static_cast<int>(m_uniforms.size());
+    m_uniforms.push_back(Uniform{location, false, 0.f, 0});
+    m_handles.emplace(name, handle);
+    return handle;
+}
+
+//--------------------------------------------------------------------
+void RenderPass::setUniform(const int uniform, const float value)
+{
+    assert(uniform >= 0 && uniform < static_cast<int>(m_uniforms.size()));
+
+    auto& cached = m_uniforms[uniform];
+    if (cached.set && cached.value == value) {
+        return;
+    }
+
+    cached.set = true;
+    cached.value = value;
+    if (cached.location != -1) {
+        m_state.useProgram(m_program);
+        glUniform1f(cached.location, value);
+        m_state.count();
+    }
+}
+
+//--------------------------------------------------------------------
+void RenderPass::setUniform(const int uniform, const GLint value)
+{
+    assert(uniform >= 0 && uniform < static_cast<int>(m_uniforms.size()));
+
+    auto& cached = m_uniforms[uniform];
+    if (cached.set && cached.integer == value) {
+        return;
+    }
+
+    cached.set = true;
+    cached.integer = value;
+    if (cached.location != -1) {
+        m_state.useProgram(m_program);
+        glUniform1i(cached.location, value);
+        m_state.count();
+    }
+}
+
+//--------------------------------------------------------------------
+void RenderPass::draw(const int variant, const GLsizei count)
+{
+    assert(variant >= 0 && variant < static_cast<int>(m_vaos.size()));
+
+    m_state.useProgram(m_program);
+    m_state.bindVertexArray(m_vaos[variant]);
+
+    if (m_indexed) {
+        glDrawElements(m_mode, count, GL_UNSIGNED_INT, nullptr);
+    } else {
+        glDrawArrays(m_mode, 0, count);
+    }
+    m_state.count();
+}
+
+//--------------------------------------------------------------------
+void RenderPass::drawInstanced(const int variant, const GLsizei count, const GLsizei instances)
+{
+    assert(variant >= 0 && variant < static_cast<int>(m_vaos.size()));
+    assert(!m_indexed);
+
+    m_state.useProgram(m_program);
+    m_state.bindVertexArray(m_vaos[variant]);
+
+    glDrawArraysInstanced(m_mode, 0, count, instances);
+    m_state.count();
+}
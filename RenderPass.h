@@ -0,0 +1,281 @@
+/*
+ File: RenderPass.h
+ Created on: 17/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RENDERPASS_H_
+#define RENDERPASS_H_
+
+// OpenGL
+#include <GL/gl.h>
+#include <GL/glext.h>
+
+// C++
+#include <array>
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+/** \class GLState
+ * \brief Cache of the GL bindings and capabilities that change during a frame. Calls that wouldn't change the
+ * current state are skipped. The state is unknown on construction, so the first call of each kind is always issued.
+ * Only the calls made through the cache or a RenderPass are counted.
+ *
+ */
+class GLState
+{
+  public:
+    /** \brief GLState class constructor.
+     *
+     */
+    GLState();
+
+    GLState(const GLState&) = delete;
+    GLState& operator=(const GLState&) = delete;
+
+    /** \brief Makes the given program current.
+     * \param[in] program GL program name.
+     *
+     */
+    void useProgram(const GLuint program);
+
+    /** \brief Binds the given vertex array.
+     * \param[in] vao GL vertex array name.
+     *
+     */
+    void bindVertexArray(const GLuint vao);
+
+    /** \brief Binds the given buffer to GL_ARRAY_BUFFER. The element array binding is part of the vertex array
+     * state and isn't cached.
+     * \param[in] buffer GL buffer name.
+     *
+     */
+    void bindArrayBuffer(const GLuint buffer);
+
+    /** \brief Binds the given framebuffer to GL_FRAMEBUFFER.
+     * \param[in] framebuffer GL framebuffer name, 0 for the default framebuffer.
+     *
+     */
+    void bindFramebuffer(const GLuint framebuffer);
+
+    /** \brief Binds the given texture to GL_TEXTURE_2D of the active texture unit.
+     * \param[in] texture GL texture name.
+     *
+     */
+    void bindTexture(const GLuint texture);
+
+    /** \brief Sets the viewport.
+     * \param[in] width viewport width in pixels.
+     * \param[in] height viewport height in pixels.
+     *
+     */
+    void setViewport(const GLsizei width, const GLsizei height);
+
+    /** \brief Sets the scissor rectangle, used when GL_SCISSOR_TEST is enabled.
+     * \param[in] x left edge in pixels.
+     * \param[in] y bottom edge in pixels.
+     * \param[in] width rectangle width in pixels.
+     * \param[in] height rectangle height in pixels.
+     *
+     */
+    void setScissor(const GLint x, const GLint y, const GLsizei width, const GLsizei height);
+
+    /** \brief Enables or disables the given capability.
+     * \param[in] capability GL capability.
+     * \param[in] enabled true to enable and false to disable.
+     *
+     */
+    void setEnabled(const GLenum capability, const bool enabled);
+
+    /** \brief Uploads the given data to a part of the given buffer, bound to GL_ARRAY_BUFFER.
+     * \param[in] buffer GL buffer name.
+     * \param[in] offset offset in bytes in the buffer.
+     * \param[in] size size in bytes of the data.
+     * \param[in] data data to upload.
+     *
+     */
+    void bufferSubData(const GLuint buffer, const std::size_t offset, const std::size_t size, const void* data);
+
+    /** \brief Clears the buffers of the current framebuffer.
+     * \param[in] mask buffers to clear.
+     *
+     */
+    void clear(const GLbitfield mask);
+
+    /** \brief Counts GL calls issued by the caller.
+     * \param[in] calls number of calls.
+     *
+     */
+    inline void count(const unsigned int calls = 1)
+    {
+        m_calls += calls;
+    }
+
+    /** \brief Ends the frame, the calls counted from now on belong to the next frame.
+     *
+     */
+    void endFrame();
+
+    /** \brief Returns the number of GL calls issued in the last finished frame.
+     *
+     */
+    inline unsigned int frameCalls() const
+    {
+        return m_frameCalls;
+    }
+
+  private:
+    GLuint m_program;                  /** current program.                         */
+    GLuint m_vao;                      /** current vertex array.                    */
+    GLuint m_arrayBuffer;              /** buffer bound to GL_ARRAY_BUFFER.         */
+    GLuint m_framebuffer;              /** framebuffer bound to GL_FRAMEBUFFER.     */
+    GLuint m_texture;                  /** texture bound to GL_TEXTURE_2D.          */
+    std::array<GLsizei, 2> m_viewport; /** viewport size, at the origin.            */
+    std::array<GLint, 4> m_scissor;    /** scissor rectangle.                       */
+    std::map<GLenum, bool> m_enabled;  /** known state of the capabilities.         */
+    unsigned int m_calls;              /** calls issued in the current frame.       */
+    unsigned int m_frameCalls;         /** calls issued in the last finished frame. */
+};
+
+/** \class RenderPass
+ * \brief Program, primitive and vertex arrays of a draw. The vertex arrays are configured once on setup, a pass
+ * has one vertex array per variant of its inputs, like the regions of a streaming buffer, and the draw only binds
+ * the program and the vertex array of the variant. Uniforms are cached and only set when their value changes.
+ *
+ */
+class RenderPass
+{
+  public:
+    /** \brief RenderPass class constructor.
+     * \param[in] state GL state cache used to bind and draw.
+     * \param[in] program GL program name.
+     * \param[in] mode primitive of the draws.
+     * \param[in] variants number of vertex arrays.
+     *
+     */
+    explicit RenderPass(GLState& state, const GLuint program, const GLenum mode, const int variants = 1);
+
+    /** \brief RenderPass class destructor. Deletes the vertex arrays.
+     *
+     */
+    ~RenderPass();
+
+    RenderPass(const RenderPass&) = delete;
+    RenderPass& operator=(const RenderPass&) = delete;
+
+    /** \brief Configures and enables an attribute of the vertex array of the given variant.
+     * \param[in] variant vertex array index.
+     * \param[in] index attribute index.
+     * \param[in] buffer GL buffer name with the attribute values.
+     * \param[in] size number of components.
+     * \param[in] type type of the components.
+     * \param[in] normalized GL_TRUE to normalize integer components.
+     * \param[in] stride stride in bytes between the values.
+     * \param[in] offset offset in bytes of the first value in the buffer.
+     * \param[in] divisor 0 to advance the attribute per vertex, n to advance it every n instances.
+     *
+     */
+    void setAttribute(const int variant, const GLuint index, const GLuint buffer, const GLint size, const GLenum type,
+                      const GLboolean normalized, const GLsizei stride, const std::size_t offset,
+                      const GLuint divisor = 0);
+
+    /** \brief Sets the element buffer of all the vertex arrays, the draws are indexed from then on.
+     * \param[in] buffer GL buffer name with unsigned int indices.
+     *
+     */
+    void setElements(const GLuint buffer);
+
+    /** \brief Returns the handle of the given uniform of the program, its location is only queried the first time.
+     * Uniforms set every frame keep the handle and skip the lookup by name.
+     * \param[in] name uniform name.
+     *
+     */
+    int uniform(const std::string& name);
+
+    /** \brief Sets the value of a float uniform of the program if it has changed.
+     * \param[in] uniform uniform handle.
+     * \param[in] value uniform value.
+     *
+     */
+    void setUniform(const int uniform, const float value);
+
+    /** \brief Sets the value of an int or bool uniform of the program if it has changed.
+     * \param[in] uniform uniform handle.
+     * \param[in] value uniform value.
+     *
+     */
+    void setUniform(const int uniform, const GLint value);
+
+    /** \brief Sets the value of a float uniform of the program if it has changed.
+     * \param[in] name uniform name.
+     * \param[in] value uniform value.
+     *
+     */
+    inline void setUniform(const std::string& name, const float value)
+    {
+        setUniform(uniform(name), value);
+    }
+
+    /** \brief Sets the value of an int or bool uniform of the program if it has changed.
+     * \param[in] name uniform name.
+     * \param[in] value uniform value.
+     *
+     */
+    inline void setUniform(const std::string& name, const GLint value)
+    {
+        setUniform(uniform(name), value);
+    }
+
+    /** \brief Draws with the vertex array of the given variant.
+     * \param[in] variant vertex array index.
+     * \param[in] count number of vertices or indices.
+     *
+     */
+    void draw(const int variant, const GLsizei count);
+
+    /** \brief Draws instances of the same vertices with the vertex array of the given variant. Not indexed.
+     * \param[in] variant vertex array index.
+     * \param[in] count number of vertices of each instance.
+     * \param[in] instances number of instances.
+     *
+     */
+    void drawInstanced(const int variant, const GLsizei count, const GLsizei instances);
+
+  private:
+    /** \struct Uniform
+     * \brief Location and last value of an uniform.
+     *
+     */
+    struct Uniform
+    {
+        GLint location; /** uniform location, -1 if not active. */
+        bool set;       /** true once a value has been set.     */
+        float value;    /** last float value set.               */
+        GLint integer;  /** last int value set.                 */
+    };
+
+    GLState& m_state;                          /** GL state cache.                         */
+    const GLuint m_program;                    /** GL program name.                        */
+    const GLenum m_mode;                       /** primitive of the draws.                 */
+    std::vector<GLuint> m_vaos;                /** vertex arrays, one per variant.         */
+    bool m_indexed;                            /** true if the draws use an element array. */
+    std::vector<Uniform> m_uniforms;           /** uniforms, by handle.                    */
+    std::map<std::string, int> m_handles;      /** uniform handles, by name.               */
+};
+
+#endif // RENDERPASS_H_
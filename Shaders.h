@@ -27,12 +27,14 @@ layout(location = 0) in vec2 inPos;
 layout(location = 1) in vec4 inColor;
 layout(location = 2) in float inWidth;
 
+uniform float widthScale;
+
 out vec4 vColor;
 
 void main()
 {
     gl_Position = vec4(inPos, 0, 1);
-    gl_PointSize = max(1.f,inWidth);
+    gl_PointSize = max(1.f,inWidth * widthScale);
     vColor = inColor;
 }
 )";
@@ -47,31 +49,71 @@ void main()
 }
 )";
 
-// Lines shaders
+// Lines shaders. Each instance is a particle and each vertex a segment of its trail, the segments are expanded to
+// quads in the geometry shader. Older segments are drawn first and fade. The positions of the last frames are a ring
+// of regions of numPoints positions read as a buffer texture, the region of the current frame is head. Trails don't
+// reach back past the birth of the particle, the older segments collapse on the birth position.
 const char* vertexShaderSourceTrails = R"(
 #version 330 core
-layout(location = 0) in vec2 inPos;
 layout(location = 1) in vec4 inColor;
 layout(location = 2) in float inWidth;
 
+layout(location = 3) in vec3 inBirth;
+
+uniform float widthScale;
+uniform samplerBuffer history;
+uniform int packedPositions;
+uniform int head;
+uniform int regions;
+uniform int numPoints;
+uniform int frame;
+uniform int trailLength;
+
+// Frames since the birth of the particle, both frames are counted modulo 2^24.
+int particleAge()
+{
+    int born = int(dot(inBirth, vec3(1.f, 256.f, 65536.f)));
+    return (frame - born) & 0xFFFFFF;
+}
+
+// Position of the particle the given number of frames ago.
+vec2 historyPosition(int age, int back)
+{
+    int slot = (head - min(back, age) + regions) % regions;
+    vec2 value = texelFetch(history, slot * numPoints + gl_InstanceID).rg;
+    if (packedPositions != 0) {
+        // Packed positions are read as unsigned normalized values, convert them to signed like the attributes.
+        vec2 bits = round(value * 65535.f);
+        bits -= step(32768.f, bits) * 65536.f;
+        value = max(bits * (1.f / 32767.f), -1.f);
+    }
+    return value;
+}
+
 out vec4 vColor;
+out vec2 vTail;
 out float lineWidth;
 
 void main()
 {
-    gl_Position = vec4(inPos, 0, 1);
-    vColor = inColor;
-    lineWidth = max(1.f,inWidth);
+    int segment = trailLength - 1 - gl_VertexID;
+    int age = particleAge();
+
+    gl_Position = vec4(historyPosition(age, segment), 0, 1);
+    vTail = historyPosition(age, segment + 1);
+    vColor = inColor * pow(0.75, float(segment));
+    lineWidth = max(1.f,inWidth * widthScale);
 }
 )";
 
 const char* geometryShaderSource = R"(
 #version 330 core
 
-layout (lines) in;
+layout (points) in;
 layout (triangle_strip, max_vertices = 4) out;
 
 in vec4 vColor[];
+in vec2 vTail[];
 in float lineWidth[];
 
 out vec4 gColor;
@@ -81,37 +123,109 @@ uniform float ratioY;
 
 void main()
 {
-    float r1 = lineWidth[0];
-    float r2 = lineWidth[1];
-
     vec4 p1 = gl_in[0].gl_Position;
-    vec4 p2 = gl_in[1].gl_Position;
+    vec4 p2 = vec4(vTail[0], 0, 1);
 
+    // Zero length segments have no direction, the quad collapses instead of getting NaN vertices.
     vec2 dir = p2.xy - p1.xy;
-    vec2 ndir = normalize(p2.xy - p1.xy);
+    float len = length(dir);
+    vec2 ndir = len > 0.f ? dir / len : vec2(0.f);
     vec2 normal = vec2(ndir.y, -ndir.x) * vec2(ratioX, ratioY);
 
-    vec4 offset1 = vec4(normal * r1 / 2.f, 0, 0);
-    vec4 offset2 = vec4(normal * r2 / 2.f, 0, 0);
+    vec4 offset = vec4(normal * lineWidth[0] / 2.f, 0, 0);
 
     gColor = vColor[0];
 
-    gl_Position = p1 + offset1;
+    gl_Position = p1 + offset;
     EmitVertex();
-    gl_Position = p1 - offset1;
+    gl_Position = p1 - offset;
     EmitVertex();
     
-    gColor = vColor[1] * 0.75;
+    gColor = vColor[0] * 0.75;
 
-    gl_Position = p2 + offset2 + (0.87f * vec4(dir, 0, 0));
+    gl_Position = p2 + offset + (0.87f * vec4(dir, 0, 0));
     EmitVertex();
-    gl_Position = p2 - offset2 + (0.87f * vec4(dir, 0, 0));
+    gl_Position = p2 - offset + (0.87f * vec4(dir, 0, 0));
     EmitVertex();
     
     EndPrimitive();
 }
 )";
 
+// Instanced trails shader, draws the quads of the geometry shader as two triangles per segment. Each instance is a
+// particle, the segment and the quad corner come from the vertex index. Reads the positions like the lines shader.
+const char* vertexShaderSourceTrailsInstanced = R"(
+#version 330 core
+layout(location = 1) in vec4 inColor;
+layout(location = 2) in float inWidth;
+layout(location = 3) in vec3 inBirth;
+
+uniform float widthScale;
+uniform float ratioX;
+uniform float ratioY;
+uniform samplerBuffer history;
+uniform int packedPositions;
+uniform int head;
+uniform int regions;
+uniform int numPoints;
+uniform int frame;
+uniform int trailLength;
+
+// Frames since the birth of the particle, both frames are counted modulo 2^24.
+int particleAge()
+{
+    int born = int(dot(inBirth, vec3(1.f, 256.f, 65536.f)));
+    return (frame - born) & 0xFFFFFF;
+}
+
+// Position of the particle the given number of frames ago.
+vec2 historyPosition(int age, int back)
+{
+    int slot = (head - min(back, age) + regions) % regions;
+    vec2 value = texelFetch(history, slot * numPoints + gl_InstanceID).rg;
+    if (packedPositions != 0) {
+        // Packed positions are read as unsigned normalized values, convert them to signed like the attributes.
+        vec2 bits = round(value * 65535.f);
+        bits -= step(32768.f, bits) * 65536.f;
+        value = max(bits * (1.f / 32767.f), -1.f);
+    }
+    return value;
+}
+
+out vec4 gColor;
+
+const int CORNERS[6] = int[6](0, 1, 2, 2, 1, 3);
+
+void main()
+{
+    int segment = trailLength - 1 - gl_VertexID / 6;
+    int corner = CORNERS[gl_VertexID % 6];
+    bool tail = corner >= 2;
+    float side = (corner & 1) == 0 ? 1.f : -1.f;
+
+    int age = particleAge();
+    vec2 p1 = historyPosition(age, segment);
+    vec2 p2 = historyPosition(age, segment + 1);
+
+    vec2 dir = p2 - p1;
+    float len = length(dir);
+    vec2 ndir = len > 0.f ? dir / len : vec2(0.f);
+    vec2 normal = vec2(ndir.y, -ndir.x) * vec2(ratioX, ratioY);
+
+    float width = max(1.f, inWidth * widthScale);
+    vec2 offset = normal * width / 2.f;
+
+    vec2 pos = (tail ? p2 : p1) + side * offset;
+    if (tail) {
+        pos += 0.87f * dir;
+    }
+
+    vec4 color = inColor * pow(0.75, float(segment));
+    gl_Position = vec4(pos, 0, 1);
+    gColor = tail ? color * 0.75 : color;
+}
+)";
+
 const char* fragmentShaderSourceTrails = R"(
 #version 330 core
 in vec4 gColor;
@@ -147,6 +261,22 @@ void main()
 }
 )";
 
+// Motion blur decay shader, fades the accumulated colors of the previous frame. The faded colors are truncated to
+// the 8 bit steps of the accumulation texture, rounding them would keep the dim colors from ever reaching black.
+const char* decayFragmentShaderSource = R"(
+#version 330 core
+in vec2 TexCoord;
+
+uniform sampler2D screenTexture;
+uniform float decay;
+
+void main()
+{
+    vec4 steps = round(texture(screenTexture, TexCoord) * 255.f);
+    gl_FragColor = floor(steps * decay) / 255.f;
+}
+)";
+
 const float quadVertices[] = {
     -1.0f, 1.0f,  // Top-left
     -1.0f, -1.0f, // Bottom-left
@@ -0,0 +1,643 @@
+/*
+ File: SoftwareRenderer.cpp
+ Created on: 17/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// The raster functions are always inlined, their vector arguments never use the calling convention.
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+// Project
+#include <SoftwareRenderer.h>
+
+// C++
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define RASTER_X86 1
+#endif
+
+#define RASTER_INLINE inline __attribute__((always_inline))
+
+namespace
+{
+    const int TILE_SIZE = 64;                   /** tile width and height in pixels.                        */
+    const int TILE_STRIDE = TILE_SIZE + 16;     /** row stride of a tile, vector stores can pass the end.   */
+    const float TAIL = 0.87f;                   /** extension of the trail segments, like the shaders.      */
+    const float FADE = 0.75f;                   /** color of the tail of a segment relative to its head.    */
+    const std::uint32_t CLEAR = 0xFF000000u;    /** clear color, opaque black.                              */
+    const int SUBPIXELS = 256;                  /** subpixel steps of the window coordinates and sizes.     */
+    const std::size_t PREFETCH = 8;             /** trails ahead whose history is prefetched.               */
+
+    using Point = SoftwareRenderer::Point;
+    using Trail = SoftwareRenderer::Trail;
+
+    /** \struct Vector
+     * \brief Vector types of W lanes.
+     *
+     */
+    template <int W>
+    struct Vector
+    {
+        typedef float f __attribute__((vector_size(W * sizeof(float))));
+        typedef std::int32_t i __attribute__((vector_size(W * sizeof(std::int32_t))));
+        typedef std::uint32_t u __attribute__((vector_size(W * sizeof(std::uint32_t))));
+    };
+
+    /** \struct Vertex
+     * \brief Corner of a trail segment in window coordinates.
+     *
+     */
+    struct Vertex
+    {
+        float x; /** x in pixels. */
+        float y; /** y in pixels. */
+    };
+
+    /** \struct Frame
+     * \brief Data of the frame shared by the tiles.
+     *
+     */
+    struct Frame
+    {
+        int width;                                     /** framebuffer width.                             */
+        int height;                                    /** framebuffer height.                            */
+        int tilesX;                                    /** number of tile columns.                        */
+        int tiles;                                     /** number of tiles.                               */
+        int parts;                                     /** number of parts of the bins.                   */
+        int trailLength;                               /** segments of the trails.                        */
+        bool blur;                                     /** true to fade the previous frame.               */
+        const float* history;                          /** ring of the last positions of each particle.   */
+        int head;                                      /** ring slot of the current frame.                */
+        int slots;                                     /** number of slots of the ring.                   */
+        float fades[Utils::MAX_TRAIL_LENGTH];          /** color of each segment relative to the head.    */
+        std::uint32_t decay[256];                      /** faded values of the bytes for the motion blur. */
+        const std::vector<std::vector<Trail>>* trails; /** binned trails.                                 */
+        const std::vector<std::vector<Point>>* points; /** binned points.                                 */
+        std::uint32_t* pixels;                         /** framebuffer.                                   */
+    };
+
+    /** \struct Tile
+     * \brief Pixels of a tile being drawn.
+     *
+     */
+    struct Tile
+    {
+        int x0;              /** first column.                      */
+        int y0;              /** first row.                         */
+        int x1;              /** column past the last one.          */
+        int y1;              /** row past the last one.             */
+        std::uint32_t* data; /** pixels, TILE_STRIDE words per row. */
+    };
+
+    //--------------------------------------------------------------------
+    // Rounds a window coordinate to the subpixel grid of the rasterizers.
+    RASTER_INLINE float snap(const float value)
+    {
+        return std::floor(value * SUBPIXELS + .5f) * (1.f / SUBPIXELS);
+    }
+
+    //--------------------------------------------------------------------
+    RASTER_INLINE std::uint32_t packColor(const float* color)
+    {
+        std::uint32_t result = 0;
+        for (int c = 0; c < 4; ++c) {
+            const float value = std::min(std::max(color[c], 0.f), 1.f);
+            result |= static_cast<std::uint32_t>(value * 255.f + .5f) << (8 * c);
+        }
+        return result;
+    }
+
+    //--------------------------------------------------------------------
+    template <typename U>
+    RASTER_INLINE U maxBytes(const U& a, const U& b)
+    {
+        U result = a & 0;
+        for (int c = 0; c < 4; ++c) {
+            const U ca = (a >> (8 * c)) & 0xFF;
+            const U cb = (b >> (8 * c)) & 0xFF;
+            result |= (ca > cb ? ca : cb) << (8 * c);
+        }
+        return result;
+    }
+
+    //--------------------------------------------------------------------
+    // True if the edge from a to b of a counter clockwise polygon owns the pixels centered on it, the left edges
+    // and the top edges with the y axis up.
+    RASTER_INLINE bool topLeft(const Vertex& a, const Vertex& b)
+    {
+        return b.y < a.y || (b.y == a.y && b.x < a.x);
+    }
+
+    //--------------------------------------------------------------------
+    // Draws a trail segment, the parallelogram of the corners a, b, d and c in order with the head color on the
+    // edge ab and the tail color on the edge cd. The geometry shader draws it as the triangles abc and cbd, whose
+    // colors are the same plane, and the pixels on the shared edge belong to only one of them.
+    template <int W, bool Max>
+    RASTER_INLINE void drawSegment(const Vertex (&corners)[4], const float* head, const float* tail, const Tile& tile)
+    {
+        using F = typename Vector<W>::f;
+        using I = typename Vector<W>::i;
+        using U = typename Vector<W>::u;
+
+        const Vertex& a = corners[0];
+        const Vertex& b = corners[1];
+        const Vertex& c = corners[3];
+        const float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+        if (!(area != 0.f)) {
+            return;
+        }
+
+        // Pixels whose centers are inside the bounding box, clipped to the tile.
+        float minX = a.x, maxX = a.x, minY = a.y, maxY = a.y;
+        for (const auto& corner : corners) {
+            minX = std::min(minX, corner.x);
+            maxX = std::max(maxX, corner.x);
+            minY = std::min(minY, corner.y);
+            maxY = std::max(maxY, corner.y);
+        }
+        const int x0 = std::max(tile.x0, static_cast<int>(std::ceil(minX - .5f)));
+        const int x1 = std::min(tile.x1, static_cast<int>(std::floor(maxX - .5f)) + 1);
+        const int y0 = std::max(tile.y0, static_cast<int>(std::ceil(minY - .5f)));
+        const int y1 = std::min(tile.y1, static_cast<int>(std::floor(maxY - .5f)) + 1);
+        if (x0 >= x1 || y0 >= y1) {
+            return;
+        }
+
+        // The edges go counter clockwise, the inside is on their left.
+        float ex[4], ey[4], dx[4], dy[4];
+        std::int32_t owned[4];
+        for (int e = 0; e < 4; ++e) {
+            const Vertex& from = corners[area > 0.f ? e : 3 - e];
+            const Vertex& to = corners[area > 0.f ? (e + 1) % 4 : (6 - e) % 4];
+            ex[e] = from.x;
+            ey[e] = from.y;
+            dx[e] = to.x - from.x;
+            dy[e] = to.y - from.y;
+            owned[e] = topLeft(from, to) ? -1 : 0;
+        }
+
+        // The color changes along the segment, with the distance to the edge ab.
+        const float inverse = 1.f / area;
+        const float abX = b.x - a.x;
+        const float abY = b.y - a.y;
+        float change[4];
+        for (int k = 0; k < 4; ++k) {
+            change[k] = tail[k] - head[k];
+        }
+
+        F lanes;
+        I laneIndex;
+        for (int l = 0; l < W; ++l) {
+            lanes[l] = l + .5f;
+            laneIndex[l] = l;
+        }
+
+        for (int y = y0; y < y1; ++y) {
+            const float py = y + .5f;
+            std::uint32_t* row = tile.data + (y - tile.y0) * TILE_STRIDE - tile.x0;
+
+            for (int x = x0; x < x1; x += W) {
+                const F px = lanes + static_cast<float>(x);
+
+                I inside = (laneIndex + x) < x1;
+                for (int e = 0; e < 4; ++e) {
+                    const F edge = dx[e] * (py - ey[e]) - dy[e] * (px - ex[e]);
+                    inside &= (edge > 0.f) | ((edge == 0.f) & owned[e]);
+                }
+
+                std::uint64_t any = 0;
+                std::uint64_t words[W / 2];
+                __builtin_memcpy(words, &inside, sizeof(words));
+                for (const auto word : words) {
+                    any |= word;
+                }
+                if (!any) {
+                    continue;
+                }
+
+                const F along = (abX * (py - a.y) - abY * (px - a.x)) * inverse;
+                U color = U{} + 0;
+                for (int k = 0; k < 4; ++k) {
+                    F value = head[k] + change[k] * along;
+                    value = value < 0.f ? F{} + 0.f : value;
+                    value = value > 1.f ? F{} + 1.f : value;
+                    const U bytes = __builtin_convertvector(value * 255.f + .5f, U);
+                    color |= bytes << (8 * k);
+                }
+
+                U old;
+                __builtin_memcpy(&old, row + x, sizeof(old));
+                if (Max) {
+                    color = maxBytes(color, old);
+                }
+                const U result = inside ? color : old;
+                __builtin_memcpy(row + x, &result, sizeof(result));
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------
+    // Draws the segments of a trail as the trail shaders, oldest segment first.
+    template <int W, bool Max>
+    RASTER_INLINE void drawTrail(const Frame& frame, const Trail& trail, const Tile& tile)
+    {
+        // Positions of the last frames, newest first, the ones before the birth are the birth position.
+        float x[Utils::MAX_TRAIL_LENGTH + 1];
+        float y[Utils::MAX_TRAIL_LENGTH + 1];
+        const float* history = frame.history + 2 * static_cast<std::size_t>(trail.index) * frame.slots;
+        for (int back = 0; back <= frame.trailLength; ++back) {
+            const int slot = (frame.head - std::min(back, trail.age) + frame.slots) % frame.slots;
+            x[back] = history[2 * slot];
+            y[back] = history[2 * slot + 1];
+        }
+
+        const float ratioX = 2.f / frame.width;
+        const float ratioY = 2.f / frame.height;
+        const float halfWidth = trail.width / 2.f;
+        const auto toWindow = [&frame](Vertex& vertex, const float px, const float py) {
+            vertex.x = snap((px + 1.f) * .5f * frame.width);
+            vertex.y = snap((py + 1.f) * .5f * frame.height);
+        };
+
+        for (int segment = frame.trailLength - 1; segment >= 0; --segment) {
+            const float dirX = x[segment + 1] - x[segment];
+            const float dirY = y[segment + 1] - y[segment];
+            const float length = std::sqrt(dirX * dirX + dirY * dirY);
+            const float offsetX = length > 0.f ? dirY / length * ratioX * halfWidth : 0.f;
+            const float offsetY = length > 0.f ? -dirX / length * ratioY * halfWidth : 0.f;
+            const float endX = x[segment + 1] + TAIL * dirX;
+            const float endY = y[segment + 1] + TAIL * dirY;
+
+            Vertex corners[4];
+            toWindow(corners[0], x[segment] + offsetX, y[segment] + offsetY);
+            toWindow(corners[1], x[segment] - offsetX, y[segment] - offsetY);
+            toWindow(corners[2], endX - offsetX, endY - offsetY);
+            toWindow(corners[3], endX + offsetX, endY + offsetY);
+
+            float head[4];
+            float tail[4];
+            for (int c = 0; c < 4; ++c) {
+                head[c] = trail.color[c] * frame.fades[segment];
+                tail[c] = head[c] * FADE;
+            }
+
+            drawSegment<W, Max>(corners, head, tail, tile);
+        }
+    }
+
+    //--------------------------------------------------------------------
+    template <bool Max>
+    RASTER_INLINE void drawPoint(const Point& point, const Tile& tile)
+    {
+        const int x0 = std::max(tile.x0, point.left);
+        const int x1 = std::min(tile.x1, point.left + point.size);
+        const int y0 = std::max(tile.y0, point.bottom);
+        const int y1 = std::min(tile.y1, point.bottom + point.size);
+
+        for (int y = y0; y < y1; ++y) {
+            std::uint32_t* row = tile.data + (y - tile.y0) * TILE_STRIDE - tile.x0;
+            for (int x = x0; x < x1; ++x) {
+                row[x] = Max ? maxBytes(point.color, row[x]) : point.color;
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------
+    template <int W, bool Max>
+    RASTER_INLINE void drawTileVector(const Frame& frame, const int index)
+    {
+        alignas(64) std::uint32_t data[TILE_SIZE * TILE_STRIDE];
+
+        Tile tile;
+        tile.x0 = (index % frame.tilesX) * TILE_SIZE;
+        tile.y0 = (index / frame.tilesX) * TILE_SIZE;
+        tile.x1 = std::min(tile.x0 + TILE_SIZE, frame.width);
+        tile.y1 = std::min(tile.y0 + TILE_SIZE, frame.height);
+        tile.data = data;
+
+        for (int y = tile.y0; y < tile.y1; ++y) {
+            const std::uint32_t* source = frame.pixels + static_cast<std::size_t>(y) * frame.width;
+            std::uint32_t* row = data + (y - tile.y0) * TILE_STRIDE - tile.x0;
+            for (int x = tile.x0; x < tile.x1; ++x) {
+                if (frame.blur) {
+                    const std::uint32_t value = source[x];
+                    row[x] = frame.decay[value & 0xFF] | (frame.decay[(value >> 8) & 0xFF] << 8) |
+                             (frame.decay[(value >> 16) & 0xFF] << 16) | (frame.decay[value >> 24] << 24);
+                } else {
+                    row[x] = CLEAR;
+                }
+            }
+        }
+
+        // Same order as the GL passes: every trail, then every point, in particle order.
+        // The histories of the trails of a tile are scattered, they are prefetched a few trails ahead.
+        const std::size_t historySize = 2 * static_cast<std::size_t>(frame.slots);
+        for (int part = 0; part < frame.parts; ++part) {
+            const auto& trails = (*frame.trails)[part * frame.tiles + index];
+            for (std::size_t i = 0; i < trails.size(); ++i) {
+                if (i + PREFETCH < trails.size()) {
+                    const float* history = frame.history + trails[i + PREFETCH].index * historySize;
+                    for (std::size_t offset = 0; offset < historySize; offset += 16) {
+                        __builtin_prefetch(history + offset);
+                    }
+                }
+                drawTrail<W, Max>(frame, trails[i], tile);
+            }
+        }
+
+        for (int part = 0; part < frame.parts; ++part) {
+            for (const auto& point : (*frame.points)[part * frame.tiles + index]) {
+                drawPoint<Max>(point, tile);
+            }
+        }
+
+        for (int y = tile.y0; y < tile.y1; ++y) {
+            std::uint32_t* target = frame.pixels + static_cast<std::size_t>(y) * frame.width;
+            const std::uint32_t* row = data + (y - tile.y0) * TILE_STRIDE - tile.x0;
+            std::copy(row + tile.x0, row + tile.x1, target + tile.x0);
+        }
+    }
+
+    using DrawTile = void (*)(const Frame& frame, const int index);
+
+    /** \struct Generic
+     * \brief Rasterizer of 4 lanes for the baseline instruction set.
+     *
+     */
+    struct Generic
+    {
+        template <bool Max>
+        static void drawTile(const Frame& frame, const int index)
+        {
+            drawTileVector<4, Max>(frame, index);
+        }
+    };
+
+#ifdef RASTER_X86
+    /** \struct SSE4
+     * \brief SSE4.1 rasterizer, 4 lanes.
+     *
+     */
+    struct SSE4
+    {
+        template <bool Max>
+        __attribute__((target("sse4.1"))) static void drawTile(const Frame& frame, const int index)
+        {
+            drawTileVector<4, Max>(frame, index);
+        }
+    };
+
+    /** \struct AVX2
+     * \brief AVX2 rasterizer, 8 lanes.
+     *
+     */
+    struct AVX2
+    {
+        template <bool Max>
+        __attribute__((target("avx2"))) static void drawTile(const Frame& frame, const int index)
+        {
+            drawTileVector<8, Max>(frame, index);
+        }
+    };
+
+    /** \struct AVX512
+     * \brief AVX-512 rasterizer, 16 lanes.
+     *
+     */
+    struct AVX512
+    {
+        template <bool Max>
+        __attribute__((target("avx512f"))) static void drawTile(const Frame& frame, const int index)
+        {
+            drawTileVector<16, Max>(frame, index);
+        }
+    };
+#endif
+
+    //--------------------------------------------------------------------
+    template <typename Set>
+    DrawTile drawTileFunction(const bool blur)
+    {
+        return blur ? &Set::template drawTile<true> : &Set::template drawTile<false>;
+    }
+
+    //--------------------------------------------------------------------
+    DrawTile drawTileFunction(const Kernels::Isa isa, const bool blur)
+    {
+        switch (isa) {
+#ifdef RASTER_X86
+            case Kernels::Isa::SSE4:
+                return drawTileFunction<SSE4>(blur);
+            case Kernels::Isa::AVX2:
+                return drawTileFunction<AVX2>(blur);
+            case Kernels::Isa::AVX512:
+                return drawTileFunction<AVX512>(blur);
+#endif
+            default:
+            case Kernels::Isa::SCALAR:
+                break;
+        }
+
+        return drawTileFunction<Generic>(blur);
+    }
+} // namespace
+
+//--------------------------------------------------------------------
+SoftwareRenderer::SoftwareRenderer(const int width, const int height, const Utils::Configuration& config) :
+    m_width{std::max(width, 1)},
+    m_height{std::max(height, 1)},
+    m_trails{config.show_trails},
+    m_trailLength{std::clamp<int>(config.trail_length, 1, Utils::MAX_TRAIL_LENGTH)},
+    m_blur{config.motion_blur},
+    m_tilesX{(m_width + TILE_SIZE - 1) / TILE_SIZE},
+    m_tilesY{(m_height + TILE_SIZE - 1) / TILE_SIZE},
+    m_isa{Kernels::detectIsa()},
+    m_pixels(static_cast<std::size_t>(m_width) * m_height, CLEAR),
+    m_numPoints{0},
+    m_head{0},
+    m_slots{m_trails ? m_trailLength + 1 : 1},
+    m_frame{0},
+    m_parts{0}
+{
+}
+
+//--------------------------------------------------------------------
+void SoftwareRenderer::setIsa(const Kernels::Isa isa)
+{
+    m_isa = isa;
+}
+
+//--------------------------------------------------------------------
+void SoftwareRenderer::render(Particles& particles)
+{
+    const int numPoints = static_cast<int>(particles.positionsSize() / 2);
+
+    // A part of the particles is binned by each thread of the pool.
+    auto& pool = particles.pool();
+    if (m_parts != static_cast<int>(pool.size())) {
+        m_parts = static_cast<int>(pool.size());
+        const auto tiles = static_cast<std::size_t>(m_tilesX) * m_tilesY;
+        m_trailBins.assign(m_parts * tiles, {});
+        m_pointBins.assign(m_parts * tiles, {});
+    }
+
+    const bool first = numPoints != m_numPoints;
+    if (first) {
+        m_numPoints = numPoints;
+        m_positions.resize(static_cast<std::size_t>(numPoints) * 2);
+        m_history.resize(m_positions.size() * m_slots);
+        m_attributes.resize(static_cast<std::size_t>(numPoints) * 6);
+        m_head = 0;
+    } else {
+        m_head = (m_head + 1) % m_slots;
+    }
+
+    particles.fillPositions(m_positions.data());
+
+    // The trails start at the first positions drawn.
+    if (first) {
+        for (std::size_t i = 0; i < m_positions.size(); i += 2) {
+            for (int slot = 0; slot < m_slots; ++slot) {
+                m_history[i * m_slots + 2 * slot] = m_positions[i];
+                m_history[i * m_slots + 2 * slot + 1] = m_positions[i + 1];
+            }
+        }
+        particles.fillAttributes(m_attributes.data(), Particles::Range{0, static_cast<std::uint32_t>(numPoints)});
+    }
+
+    for (const auto& range : particles.takeChangedRanges()) {
+        particles.fillAttributes(m_attributes.data() + 6 * static_cast<std::size_t>(range.first), range);
+    }
+    m_frame = particles.frame() % BIRTH_FRAMES;
+
+    const int partSize = (numPoints + m_parts - 1) / m_parts;
+    pool.parallelFor(m_parts, [this, partSize, numPoints](const int part) {
+        bin(part, std::min(part * partSize, numPoints), std::min((part + 1) * partSize, numPoints));
+    });
+
+    Frame frame;
+    frame.width = m_width;
+    frame.height = m_height;
+    frame.tilesX = m_tilesX;
+    frame.tiles = m_tilesX * m_tilesY;
+    frame.parts = m_parts;
+    frame.trailLength = m_trailLength;
+    frame.blur = m_blur;
+    frame.history = m_history.data();
+    frame.head = m_head;
+    frame.slots = m_slots;
+    for (int segment = 0; segment < m_trailLength; ++segment) {
+        frame.fades[segment] = std::pow(FADE, static_cast<float>(segment));
+    }
+    // The motion blur fades the previous frame like the decay shader, truncating to the 8 bit steps.
+    for (int value = 0; value < 256; ++value) {
+        frame.decay[value] = static_cast<std::uint32_t>(value * Utils::BLUR_DECAY);
+    }
+    frame.trails = &m_trailBins;
+    frame.points = &m_pointBins;
+    frame.pixels = m_pixels.data();
+
+    const auto drawTile = drawTileFunction(m_isa, m_blur);
+    pool.parallelFor(frame.tiles, [&frame, drawTile](const int tile) { drawTile(frame, tile); });
+}
+
+//--------------------------------------------------------------------
+void SoftwareRenderer::bin(const int part, const int begin, const int end)
+{
+    const int tiles = m_tilesX * m_tilesY;
+    auto trailBins = m_trailBins.begin() + part * tiles;
+    auto pointBins = m_pointBins.begin() + part * tiles;
+    for (int tile = 0; tile < tiles; ++tile) {
+        trailBins[tile].clear();
+        pointBins[tile].clear();
+    }
+
+    // Adds the record to the tiles that overlap the given rectangle in pixels.
+    const auto add = [this](auto bins, const auto& record, const float minX, const float minY, const float maxX,
+                            const float maxY) {
+        if (!(maxX >= 0.f && maxY >= 0.f && minX < m_width && minY < m_height)) {
+            return;
+        }
+
+        const int tx0 = static_cast<int>(std::max(minX, 0.f)) / TILE_SIZE;
+        const int ty0 = static_cast<int>(std::max(minY, 0.f)) / TILE_SIZE;
+        const int tx1 = static_cast<int>(std::min(maxX, m_width - 1.f)) / TILE_SIZE;
+        const int ty1 = static_cast<int>(std::min(maxY, m_height - 1.f)) / TILE_SIZE;
+        for (int ty = ty0; ty <= ty1; ++ty) {
+            for (int tx = tx0; tx <= tx1; ++tx) {
+                bins[ty * m_tilesX + tx].push_back(record);
+            }
+        }
+    };
+
+    const float scaleX = .5f * m_width;
+    const float scaleY = .5f * m_height;
+    for (int i = begin; i < end; ++i) {
+        const float* attributes = m_attributes.data() + 6 * static_cast<std::size_t>(i);
+        const float* position = m_positions.data() + 2 * static_cast<std::size_t>(i);
+        float* history = m_history.data() + 2 * static_cast<std::size_t>(i) * m_slots;
+        history[2 * m_head] = position[0];
+        history[2 * m_head + 1] = position[1];
+
+        // The segments stay between their head and their extended tail, widened by half the line width.
+        if (m_trails) {
+            Trail trail;
+            trail.index = static_cast<std::uint32_t>(i);
+            trail.age = (m_frame - static_cast<std::uint32_t>(attributes[5])) & (BIRTH_FRAMES - 1);
+            trail.width = std::max(1.f, attributes[4]);
+            std::copy(attributes, attributes + 4, trail.color);
+
+            float x1 = (position[0] + 1.f) * scaleX;
+            float y1 = (position[1] + 1.f) * scaleY;
+            float minX = x1, maxX = x1, minY = y1, maxY = y1;
+            for (int back = 1; back <= std::min(m_trailLength, trail.age); ++back) {
+                const int slot = (m_head - back + m_slots) % m_slots;
+                const float x2 = (history[2 * slot] + 1.f) * scaleX;
+                const float y2 = (history[2 * slot + 1] + 1.f) * scaleY;
+                const float tailX = x2 + TAIL * (x2 - x1);
+                const float tailY = y2 + TAIL * (y2 - y1);
+                minX = std::min(minX, std::min(x2, tailX));
+                maxX = std::max(maxX, std::max(x2, tailX));
+                minY = std::min(minY, std::min(y2, tailY));
+                maxY = std::max(maxY, std::max(y2, tailY));
+                x1 = x2;
+                y1 = y2;
+            }
+
+            const float margin = trail.width / 2.f + 1.f;
+            add(trailBins, trail, minX - margin, minY - margin, maxX + margin, maxY + margin);
+        }
+
+        // Aliased points are squares of the snapped point size rounded to an integer with the halves rounding
+        // down, around the snapped position. The pixels whose centers are on the left or bottom edges belong to
+        // the neighbours, like the GL rasterizers.
+        const int fixedSize = static_cast<int>(std::floor(attributes[4] * SUBPIXELS + .5f));
+        const float cx = snap((position[0] + 1.f) * scaleX);
+        const float cy = snap((position[1] + 1.f) * scaleY);
+
+        Point point;
+        point.size = std::max(1, (fixedSize + SUBPIXELS / 2 - 1) / SUBPIXELS);
+        point.left = static_cast<int>(std::floor(cx - point.size * .5f - .5f)) + 1;
+        point.bottom = static_cast<int>(std::floor(cy - point.size * .5f - .5f)) + 1;
+        point.color = packColor(attributes);
+
+        const float last = point.size - 1.f;
+        add(pointBins, point, point.left, point.bottom, point.left + last, point.bottom + last);
+    }
+}
@@ -0,0 +1,148 @@
+/*
+ File: SoftwareRenderer.h
+ Created on: 17/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SOFTWARERENDERER_H_
+#define SOFTWARERENDERER_H_
+
+// Project
+#include <Kernels.h>
+#include <Particle.h>
+#include <ThreadPool.h>
+#include <Utils.h>
+
+// C++
+#include <cstdint>
+#include <vector>
+
+/** \class SoftwareRenderer
+ * \brief CPU renderer of the particles, draws the same trails and points as the shaders into a RGBA framebuffer
+ * without OpenGL. The framebuffer is split in tiles rendered in parallel, each tile draws the primitives that
+ * overlap it in the same order as the GL passes so the result doesn't depend on the number of threads. The trails
+ * are rasterized a vector of pixels at a time with the instruction set of the simulation kernels.
+ *
+ */
+class SoftwareRenderer
+{
+  public:
+    /** \struct Point
+     * \brief Pixel square of a point, binned to the tiles it overlaps.
+     *
+     */
+    struct Point
+    {
+        std::int32_t left;   /** first column.        */
+        std::int32_t bottom; /** first row.           */
+        std::int32_t size;   /** side in pixels.      */
+        std::uint32_t color; /** rgba bytes of color. */
+    };
+
+    /** \struct Trail
+     * \brief Trail of a particle, binned to the tiles it overlaps.
+     *
+     */
+    struct Trail
+    {
+        std::uint32_t index; /** particle index.                      */
+        std::int32_t age;    /** frames since the particle was born.  */
+        float width;         /** line width in pixels.                */
+        float color[4];      /** rgba color of the newest segment.    */
+    };
+
+    /** \brief SoftwareRenderer class constructor.
+     * \param[in] width framebuffer width in pixels.
+     * \param[in] height framebuffer height in pixels.
+     * \param[in] config application configuration, trails, trail length and motion blur are used.
+     *
+     */
+    explicit SoftwareRenderer(const int width, const int height, const Utils::Configuration& config);
+
+    SoftwareRenderer(const SoftwareRenderer&) = delete;
+    SoftwareRenderer& operator=(const SoftwareRenderer&) = delete;
+
+    /** \brief Sets the instruction set of the rasterizer, by default the widest one supported by the CPU.
+     * \param[in] isa Instruction set.
+     *
+     */
+    void setIsa(const Kernels::Isa isa);
+
+    /** \brief Draws the current frame of the given particles with their thread pool, the frame is advanced and
+     * drawn in turns so both share the threads. Keeps the positions as the history of the trails and takes the
+     * changed ranges of the particles, so it must be their only renderer.
+     * \param[in] particles particles to draw.
+     *
+     */
+    void render(Particles& particles);
+
+    /** \brief Returns the framebuffer, r, g, b and a bytes per pixel with the rows from bottom to top, like
+     * glReadPixels().
+     *
+     */
+    inline const std::uint8_t* pixels() const
+    {
+        return reinterpret_cast<const std::uint8_t*>(m_pixels.data());
+    }
+
+    /** \brief Returns the framebuffer width in pixels.
+     *
+     */
+    inline int width() const
+    {
+        return m_width;
+    }
+
+    /** \brief Returns the framebuffer height in pixels.
+     *
+     */
+    inline int height() const
+    {
+        return m_height;
+    }
+
+  private:
+    /** \brief Stores the positions of the particles in [begin, end) in the history and bins their trails and
+     * points to the tiles they overlap.
+     * \param[in] part index of the bins of the particles.
+     * \param[in] begin index of the first particle.
+     * \param[in] end index past the last particle.
+     *
+     */
+    void bin(const int part, const int begin, const int end);
+
+    const int m_width;                           /** framebuffer width in pixels.                          */
+    const int m_height;                          /** framebuffer height in pixels.                         */
+    const bool m_trails;                         /** true to draw the trails.                              */
+    const int m_trailLength;                     /** segments of the trails.                               */
+    const bool m_blur;                           /** true to fade the previous frames instead of clearing. */
+    const int m_tilesX;                          /** number of tile columns.                               */
+    const int m_tilesY;                          /** number of tile rows.                                  */
+    Kernels::Isa m_isa;                          /** instruction set of the rasterizer.                    */
+    std::vector<std::uint32_t> m_pixels;         /** framebuffer, a rgba word per pixel.                   */
+    int m_numPoints;                             /** number of particles drawn.                            */
+    std::vector<float> m_positions;              /** positions of the current frame, x and y.              */
+    std::vector<float> m_history;                /** ring of the last positions of each particle.          */
+    int m_head;                                  /** ring slot of the current frame.                       */
+    int m_slots;                                 /** number of slots of the ring.                          */
+    std::uint32_t m_frame;                       /** current frame modulo BIRTH_FRAMES.                    */
+    std::vector<float> m_attributes;             /** r, g, b, a, width and birth frame per particle.       */
+    std::vector<std::vector<Trail>> m_trailBins; /** trails overlapping each tile, per part.               */
+    std::vector<std::vector<Point>> m_pointBins; /** points overlapping each tile, per part.               */
+    int m_parts;                                 /** number of ranges of particles binned in parallel.     */
+};
+
+#endif // SOFTWARERENDERER_H_
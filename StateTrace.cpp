@@ -0,0 +1,126 @@
+/*
+ File: StateTrace.cpp
+ Created on: 17/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <StateTrace.h>
+#include <WhirlWindWarp.h>
+
+// C++
+#include <cstring>
+
+namespace
+{
+    const char MAGIC[4] = {'W', 'W', 'W', 'T'}; /** trace file identifier. */
+    const std::uint32_t VERSION = 1;             /** trace format version.  */
+
+    /** \struct Header
+     * \brief Trace file header.
+     *
+     */
+    struct Header
+    {
+        char magic[4];          /** file identifier, MAGIC.          */
+        std::uint32_t version;  /** format version, VERSION.         */
+        std::uint64_t seed;     /** seed of the simulation.          */
+        std::int32_t numPoints; /** points of the simulation.        */
+        std::int32_t fields;    /** number of force fields, fs.      */
+    };
+
+    /** \struct Frame
+     * \brief Traced state of a frame.
+     *
+     */
+    struct __attribute__((__packed__)) Frame
+    {
+        std::uint16_t enabled;  /** enabled fields, bit i is field i. */
+        float var[fs];          /** field parameters.                 */
+        float velocity[fs];     /** field velocities.                 */
+        float acceleration[fs]; /** field accelerations.              */
+        std::int32_t hue;       /** hue value.                        */
+    };
+
+    static_assert(fs <= 16, "Enabled fields don't fit in the trace frame.");
+} // namespace
+
+//--------------------------------------------------------------------
+StateTrace::Writer::Writer(const std::string& filename, const std::uint64_t seed, const int numPoints) :
+    m_file{filename, std::ios::out | std::ios::binary | std::ios::trunc}
+{
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.seed = seed;
+    header.numPoints = numPoints;
+    header.fields = fs;
+
+    m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+//--------------------------------------------------------------------
+void StateTrace::Writer::write(const State& state)
+{
+    Frame frame;
+    frame.enabled = 0;
+    for (int i = 0; i < fs; ++i) {
+        frame.enabled |= (state.enabled[i] ? 1 : 0) << i;
+    }
+    std::memcpy(frame.var, state.var, sizeof(frame.var));
+    std::memcpy(frame.velocity, state.velocity, sizeof(frame.velocity));
+    std::memcpy(frame.acceleration, state.acceleration, sizeof(frame.acceleration));
+    frame.hue = state.hue;
+
+    m_file.write(reinterpret_cast<const char*>(&frame), sizeof(frame));
+}
+
+//--------------------------------------------------------------------
+StateTrace::Reader::Reader(const std::string& filename) :
+    m_file{filename, std::ios::in | std::ios::binary},
+    m_valid{false},
+    m_seed{0},
+    m_numPoints{0}
+{
+    Header header;
+    if (!m_file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        return;
+    }
+
+    m_valid = std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 && header.version == VERSION &&
+              header.fields == fs && header.numPoints > 0;
+    m_seed = header.seed;
+    m_numPoints = header.numPoints;
+}
+
+//--------------------------------------------------------------------
+bool StateTrace::Reader::read(State& state)
+{
+    Frame frame;
+    if (!m_valid || !m_file.read(reinterpret_cast<char*>(&frame), sizeof(frame))) {
+        return false;
+    }
+
+    for (int i = 0; i < fs; ++i) {
+        state.enabled[i] = (frame.enabled >> i) & 1;
+    }
+    std::memcpy(state.var, frame.var, sizeof(frame.var));
+    std::memcpy(state.velocity, frame.velocity, sizeof(frame.velocity));
+    std::memcpy(state.acceleration, frame.acceleration, sizeof(frame.acceleration));
+    state.hue = frame.hue;
+
+    return true;
+}
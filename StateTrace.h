@@ -0,0 +1,121 @@
+/*
+ File: StateTrace.h
+ Created on: 17/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STATETRACE_H_
+#define STATETRACE_H_
+
+// C++
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+struct State;
+
+/** \brief Binary trace of the per-frame force field state. The file has a header with the seed and the number of
+ * points, followed by one record per frame with the enabled fields as bits, the parameters, velocities and
+ * accelerations of the fields and the hue. Values are stored in the native byte order.
+ *
+ */
+namespace StateTrace
+{
+    /** \class Writer
+     * \brief Writes the state of every frame to a trace file.
+     *
+     */
+    class Writer
+    {
+      public:
+        /** \brief Writer class constructor. Creates the trace file and writes the header, check with isOpen().
+         * \param[in] filename trace file name.
+         * \param[in] seed seed of the simulation.
+         * \param[in] numPoints number of points of the simulation.
+         *
+         */
+        explicit Writer(const std::string& filename, const std::uint64_t seed, const int numPoints);
+
+        /** \brief Returns true if the file was created and all the writes succeeded.
+         *
+         */
+        bool isOpen() const
+        {
+            return static_cast<bool>(m_file);
+        }
+
+        /** \brief Appends the given state as the next frame.
+         * \param[in] state simulation state.
+         *
+         */
+        void write(const State& state);
+
+      private:
+        std::ofstream m_file; /** trace file. */
+    };
+
+    /** \class Reader
+     * \brief Reads the state of every frame from a trace file.
+     *
+     */
+    class Reader
+    {
+      public:
+        /** \brief Reader class constructor. Opens the trace file and reads the header, check with isOpen().
+         * \param[in] filename trace file name.
+         *
+         */
+        explicit Reader(const std::string& filename);
+
+        /** \brief Returns true if the file was opened and has a valid header.
+         *
+         */
+        bool isOpen() const
+        {
+            return m_valid;
+        }
+
+        /** \brief Returns the seed of the traced simulation.
+         *
+         */
+        std::uint64_t seed() const
+        {
+            return m_seed;
+        }
+
+        /** \brief Returns the number of points of the traced simulation.
+         *
+         */
+        int numPoints() const
+        {
+            return m_numPoints;
+        }
+
+        /** \brief Reads the next frame into the given state. Returns false at the end of the trace.
+         * \param[out] state simulation state, only the traced values are modified.
+         *
+         */
+        bool read(State& state);
+
+      private:
+        std::ifstream m_file;  /** trace file.                        */
+        bool m_valid;          /** true if the header is valid.       */
+        std::uint64_t m_seed;  /** seed of the traced simulation.     */
+        int m_numPoints;       /** points of the traced simulation.   */
+    };
+} // namespace StateTrace
+
+#endif // STATETRACE_H_
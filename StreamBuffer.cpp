@@ -0,0 +1,145 @@
+/*
+ File: StreamBuffer.cpp
+ Created on: 17/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <StreamBuffer.h>
+#include <external/gl_loader.h>
+
+// C++
+#include <algorithm>
+
+namespace
+{
+    const GLuint64 FENCE_TIMEOUT = 1000000;     /** fence wait timeout in nanoseconds, waits again on timeout. */
+    const GLenum TARGET = GL_COPY_WRITE_BUFFER; /** binding point of the buffer, not used to draw.             */
+
+    /** \brief Returns true if the context supports immutable buffer storage.
+     *
+     */
+    bool hasBufferStorage()
+    {
+        GLint major = 0;
+        GLint minor = 0;
+        glGetIntegerv(GL_MAJOR_VERSION, &major);
+        glGetIntegerv(GL_MINOR_VERSION, &minor);
+
+        return glBufferStorage != nullptr && (major > 4 || (major == 4 && minor >= 4));
+    }
+} // namespace
+
+//--------------------------------------------------------------------
+StreamBuffer::StreamBuffer(const std::size_t regionSize, const int regions, const int history) :
+    m_regionSize{regionSize},
+    m_history{std::max(history, 0)},
+    m_regions{std::max(regions, m_history + 2)},
+    m_buffer{0},
+    m_persistent{hasBufferStorage()},
+    m_data{nullptr},
+    m_region{0},
+    m_fences(m_regions, nullptr)
+{
+    const auto size = static_cast<GLsizeiptr>(m_regionSize * m_regions);
+
+    glGenBuffers(1, &m_buffer);
+    glBindBuffer(TARGET, m_buffer);
+
+    if (m_persistent) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(TARGET, size, nullptr, flags);
+        m_data = static_cast<char*>(glMapBufferRange(TARGET, 0, size, flags));
+
+        // Some drivers expose the entry point but fail to map, use the per frame mapping.
+        if (!m_data) {
+            glDeleteBuffers(1, &m_buffer);
+            glGenBuffers(1, &m_buffer);
+            glBindBuffer(TARGET, m_buffer);
+            m_persistent = false;
+        }
+    }
+
+    if (!m_persistent) {
+        glBufferData(TARGET, size, nullptr, GL_STREAM_DRAW);
+    }
+}
+
+//--------------------------------------------------------------------
+StreamBuffer::~StreamBuffer()
+{
+    for (auto& fence : m_fences) {
+        if (fence) {
+            glDeleteSync(fence);
+        }
+    }
+
+    if (m_data) {
+        glBindBuffer(TARGET, m_buffer);
+        glUnmapBuffer(TARGET);
+    }
+
+    glDeleteBuffers(1, &m_buffer);
+}
+
+//--------------------------------------------------------------------
+void* StreamBuffer::map()
+{
+    // The region was last read by the frame m_history frames after the one that wrote it, the fences are signaled
+    // in order so older frames have finished too.
+    auto& fence = m_fences[(m_region + m_history) % m_regions];
+    if (fence) {
+        GLenum result;
+        do {
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT);
+        } while (result == GL_TIMEOUT_EXPIRED);
+
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    if (m_persistent) {
+        return m_data + offset();
+    }
+
+    // The fence already guarantees the region isn't in use, skip the driver synchronization.
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+    glBindBuffer(TARGET, m_buffer);
+    return glMapBufferRange(TARGET, offset(), m_regionSize, flags);
+}
+
+//--------------------------------------------------------------------
+void StreamBuffer::unmap()
+{
+    // Coherent persistent mappings are visible to the GPU without flushing.
+    if (!m_persistent) {
+        glBindBuffer(TARGET, m_buffer);
+        glUnmapBuffer(TARGET);
+    }
+}
+
+//--------------------------------------------------------------------
+void StreamBuffer::fence()
+{
+    // With history the fence of an older frame may have been skipped, a newer one covers it.
+    auto& fence = m_fences[m_region];
+    if (fence) {
+        glDeleteSync(fence);
+    }
+
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    m_region = (m_region + 1) % m_regions;
+}
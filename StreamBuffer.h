@@ -0,0 +1,135 @@
+/*
+ File: StreamBuffer.h
+ Created on: 17/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STREAMBUFFER_H_
+#define STREAMBUFFER_H_
+
+// OpenGL
+#include <GL/gl.h>
+#include <GL/glext.h>
+
+// C++
+#include <cstddef>
+#include <vector>
+
+/** \class StreamBuffer
+ * \brief GL buffer with a ring of regions that the CPU writes while the GPU reads the previous ones. Each region
+ * is written once per frame and fenced after the draws that read it, so a region is never overwritten while in use.
+ * The regions can also be kept as a history of the last frames, read by the draws of the following frames.
+ * With GL 4.4 or ARB_buffer_storage the buffer is persistently mapped, otherwise the current region is mapped
+ * unsynchronized every frame. The buffer is only bound to GL_COPY_WRITE_BUFFER, so mapping it doesn't change the
+ * bindings used to draw.
+ *
+ */
+class StreamBuffer
+{
+  public:
+    /** \brief StreamBuffer class constructor. Creates the buffer.
+     * \param[in] regionSize size in bytes of a region.
+     * \param[in] regions number of regions, at least history + 2.
+     * \param[in] history number of frames after the one that writes a region whose draws also read it.
+     *
+     */
+    explicit StreamBuffer(const std::size_t regionSize, const int regions = 3, const int history = 0);
+
+    /** \brief StreamBuffer class destructor.
+     *
+     */
+    ~StreamBuffer();
+
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    /** \brief Returns the pointer to the current region, waiting for the GPU to finish the last frame that reads
+     * it if needed. The whole region must be written before calling unmap().
+     *
+     */
+    void* map();
+
+    /** \brief Finishes writing the current region. The region can be drawn from after this call.
+     *
+     */
+    void unmap();
+
+    /** \brief Fences the draws of the frame and advances to the next region.
+     *
+     */
+    void fence();
+
+    /** \brief Returns the offset in bytes of the current region in the buffer.
+     *
+     */
+    inline std::size_t offset() const
+    {
+        return offset(m_region);
+    }
+
+    /** \brief Returns the offset in bytes of the given region in the buffer.
+     * \param[in] region region index in [0, regions()).
+     *
+     */
+    inline std::size_t offset(const int region) const
+    {
+        return region * m_regionSize;
+    }
+
+    /** \brief Returns the index of the current region.
+     *
+     */
+    inline int region() const
+    {
+        return m_region;
+    }
+
+    /** \brief Returns the number of regions.
+     *
+     */
+    inline int regions() const
+    {
+        return m_regions;
+    }
+
+    /** \brief Returns the GL buffer name.
+     *
+     */
+    inline GLuint buffer() const
+    {
+        return m_buffer;
+    }
+
+    /** \brief Returns true if the buffer is persistently mapped.
+     *
+     */
+    inline bool persistent() const
+    {
+        return m_persistent;
+    }
+
+  private:
+    const std::size_t m_regionSize; /** size in bytes of a region.                              */
+    const int m_history;            /** frames after the one that writes a region that read it. */
+    const int m_regions;            /** number of regions.                                      */
+    GLuint m_buffer;                /** GL buffer name.                                         */
+    bool m_persistent;              /** true if the buffer is persistently mapped.              */
+    char* m_data;                   /** persistent mapping of the whole buffer, or null.        */
+    int m_region;                   /** current region index.                                   */
+    std::vector<GLsync> m_fences;   /** fences of the frames that wrote each region, or null.   */
+};
+
+#endif // STREAMBUFFER_H_
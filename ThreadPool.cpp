@@ -0,0 +1,116 @@
+/*
+ File: ThreadPool.cpp
+ Created on: 17/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <ThreadPool.h>
+
+// C++
+#include <algorithm>
+
+//--------------------------------------------------------------------
+ThreadPool::ThreadPool(const unsigned int threads) :
+    m_task{nullptr},
+    m_count{0},
+    m_next{0},
+    m_pending{0},
+    m_generation{0},
+    m_stop{false}
+{
+    const auto total = threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+
+    for (unsigned int i = 1; i < total; ++i) {
+        m_threads.emplace_back(&ThreadPool::run, this);
+    }
+}
+
+//--------------------------------------------------------------------
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_start.notify_all();
+
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+//--------------------------------------------------------------------
+void ThreadPool::parallelFor(const int count, const std::function<void(const int)>& task)
+{
+    if (m_threads.empty() || count < 2) {
+        for (int i = 0; i < count; ++i) {
+            task(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &task;
+        m_count = count;
+        m_next = 0;
+        m_pending = m_threads.size();
+        ++m_generation;
+    }
+    m_start.notify_all();
+
+    work();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this]() { return m_pending == 0; });
+    m_task = nullptr;
+}
+
+//--------------------------------------------------------------------
+void ThreadPool::run()
+{
+    unsigned long long generation = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_start.wait(lock, [this, generation]() { return m_stop || m_generation != generation; });
+
+            if (m_stop) {
+                return;
+            }
+
+            generation = m_generation;
+        }
+
+        work();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_pending;
+        }
+        m_done.notify_one();
+    }
+}
+
+//--------------------------------------------------------------------
+void ThreadPool::work()
+{
+    for (int i = m_next++; i < m_count; i = m_next++) {
+        (*m_task)(i);
+    }
+}
@@ -0,0 +1,91 @@
+/*
+ File: ThreadPool.h
+ Created on: 17/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef THREADPOOL_H_
+#define THREADPOOL_H_
+
+// C++
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/** \class ThreadPool
+ * \brief Fixed set of worker threads that execute the chunks of a parallel loop.
+ *
+ */
+class ThreadPool
+{
+  public:
+    /** \brief ThreadPool class constructor.
+     * \param[in] threads total number of threads including the calling one, 0 to use all the hardware threads.
+     *
+     */
+    explicit ThreadPool(const unsigned int threads = 0);
+
+    /** \brief ThreadPool class destructor. Stops and joins the worker threads.
+     *
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /** \brief Returns the number of threads that execute chunks, including the calling one.
+     *
+     */
+    inline unsigned int size() const
+    {
+        return m_threads.size() + 1;
+    }
+
+    /** \brief Calls task(i) for every i in [0, count) and returns when all calls have finished. The calling thread
+     * also executes chunks. The order in which chunks are executed is not defined.
+     * \param[in] count number of chunks.
+     * \param[in] task chunk function.
+     *
+     */
+    void parallelFor(const int count, const std::function<void(const int)>& task);
+
+  private:
+    /** \brief Worker thread loop.
+     *
+     */
+    void run();
+
+    /** \brief Executes chunks of the current loop until there are none left.
+     *
+     */
+    void work();
+
+    std::vector<std::thread> m_threads;             /** worker threads.                                 */
+    std::mutex m_mutex;                             /** protects the loop data.                         */
+    std::condition_variable m_start;                /** signals the workers a new loop.                 */
+    std::condition_variable m_done;                 /** signals the caller the end of the loop.         */
+    const std::function<void(const int)>* m_task;   /** current loop task.                              */
+    int m_count;                                    /** number of chunks of the current loop.           */
+    std::atomic<int> m_next;                        /** next chunk to execute.                          */
+    unsigned int m_pending;                         /** workers that haven't finished the current loop. */
+    unsigned long long m_generation;                /** loop counter, used to wake the workers.         */
+    bool m_stop;                                    /** true to stop the workers.                       */
+};
+
+#endif // THREADPOOL_H_
@@ -20,29 +20,11 @@
 // Project
 #include <Utils.h>
 
-// GLFW
-#include <external/gl_loader.h>
-#include <GLFW/glfw3.h>
-
 // C++
-#include <windows.h>
-#include <winreg.h>
-#include <iostream>
-#include <string>
-#include <winuser.h>
-#include <cassert>
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
-#include <fstream>
-#include <memory>
-#include <vector>
-
-LPCSTR KEY_BASEKEY = "Software\\Felix de las Pozas Alvarez\\WhirlWindWarp";
-LPCSTR KEY_MOTIONBLUR = "MotionBlur";
-LPCSTR KEY_ANTIALIAS = "Antialias";
-LPCSTR KEY_POINTSIZE = "PointSize";
-LPCSTR KEY_SHOWTRAIL = "ShowTrail";
-LPCSTR KEY_PIXELSPERPOINT = "PixelsPerPoint";
 
 //----------------------------------------------------------------------------
 std::ostream& Utils::operator<<(std::ostream& os, const Configuration& config)
@@ -52,236 +34,144 @@ std::ostream& Utils::operator<<(std::ostream& os, const Configuration& config)
        << "antialias  : " << (config.antialias ? "true" : "false") << '\n'
        << "motion blur: " << (config.motion_blur ? "true" : "false") << '\n'
        << "show trails: " << (config.show_trails ? "true" : "false") << '\n'
-       << "ppp        : " << config.pixelsPerPoint << std::endl;
+       << "ppp        : " << config.pixelsPerPoint << '\n'
+       << "packed     : " << (config.packed_vertices ? "true" : "false") << '\n'
+       << "instanced  : " << (config.instanced_trails ? "true" : "false") << '\n'
+       << "trail len  : " << config.trail_length << '\n'
+       << "blur scale : " << config.blur_scale << std::endl;
 
 
     return os;
 }
 
-//----------------------------------------------------------------------------
-void Utils::loadConfiguration(Configuration& config)
-{
-    HKEY default_key;
-    auto status = RegOpenKeyExA(HKEY_CURRENT_USER, KEY_BASEKEY, 0, KEY_QUERY_VALUE, &default_key);
-
-    if (status == ERROR_SUCCESS) {
-        DWORD dataVal = 0;
-
-        auto readRegistryValue = [&status, &dataVal, &default_key](LPCSTR key) {
-            DWORD size = sizeof(DWORD);
-            return RegGetValueA(default_key, "", key, RRF_RT_DWORD, nullptr, &dataVal, &size);
-        };
-
-        if (ERROR_SUCCESS == readRegistryValue(KEY_MOTIONBLUR)) {
-            config.motion_blur = (dataVal == 0);
-        }
-
-        if (ERROR_SUCCESS == readRegistryValue(KEY_ANTIALIAS)) {
-            config.antialias = (dataVal == 0);
-        }
-
-        if (ERROR_SUCCESS == readRegistryValue(KEY_POINTSIZE)) {
-            config.point_size = dataVal;
-        }
-
-        if (ERROR_SUCCESS == readRegistryValue(KEY_SHOWTRAIL)) {
-            config.show_trails = (dataVal == 0);
-        }
-
-        if (ERROR_SUCCESS == readRegistryValue(KEY_PIXELSPERPOINT)) {
-            config.pixelsPerPoint = dataVal;
-        }
-
-        RegCloseKey(default_key);
-    } else {
-        std::cerr << "loadConfiguration: unable to open main key." << std::endl;
-    }
-}
-
-//----------------------------------------------------------------------------
-void Utils::saveConfiguration(const Configuration& config)
+//--------------------------------------------------------------------
+Utils::FastNumberGenerator::FastNumberGenerator(const float min, const float max, const std::uint64_t seed) :
+    m_index{LANES},
+    m_min{min},
+    m_range{max - min}
 {
-    HKEY default_key;
-    auto status = RegCreateKeyExA(HKEY_CURRENT_USER, KEY_BASEKEY, 0, NULL, REG_OPTION_NON_VOLATILE, KEY_SET_VALUE, NULL,
-                                  &default_key, NULL);
-    if (status == ERROR_SUCCESS) {
-        auto saveRegistryValue = [&status, &default_key](LPCSTR key, DWORD value) {
-            return RegSetValueExA(default_key, key, 0, REG_DWORD, (BYTE*)(&value), sizeof(DWORD));
-        };
-
-        saveRegistryValue(KEY_MOTIONBLUR, config.motion_blur ? 0 : 1);
-        saveRegistryValue(KEY_ANTIALIAS, config.antialias ? 0 : 1);
-        saveRegistryValue(KEY_POINTSIZE, config.point_size);
-        saveRegistryValue(KEY_SHOWTRAIL, config.show_trails ? 0 : 1);
-        saveRegistryValue(KEY_PIXELSPERPOINT, config.pixelsPerPoint);
-
-        RegCloseKey(default_key);
-    } else {
-        std::cerr << "saveConfiguration: unable to open main key" << std::endl;
-    }
+    this->seed(seed);
 }
 
-//----------------------------------------------------------------------------
-void Utils::errorCallback(int error, const char* description)
+//--------------------------------------------------------------------
+void Utils::FastNumberGenerator::seed(const std::uint64_t seed)
 {
-    std::cout << "\n--\n" << description << "\n--\n" << std::endl;
-    std::string msg = "Error code: " + std::to_string(error) + "\nDescription: " + description;
-    std::string title = "Error";
-    MessageBoxA(nullptr, msg.c_str(), title.c_str(), MB_OK);
-    std::exit(-1);
-}
+    // Expand the seed with splitmix64, as recommended by the xoshiro authors.
+    std::uint64_t z = seed;
+    auto splitmix = [&z]() {
+        z += 0x9E3779B97F4A7C15ull;
+        std::uint64_t r = z;
+        r = (r ^ (r >> 30)) * 0xBF58476D1CE4E5B9ull;
+        r = (r ^ (r >> 27)) * 0x94D049BB133111EBull;
+        return r ^ (r >> 31);
+    };
 
-//----------------------------------------------------------------------------
-void Utils::glfwKeyCallback(GLFWwindow* window, int, int, int, int)
-{
-    glfwSetWindowShouldClose(window, GLFW_TRUE);
-}
+    for (int lane = 0; lane < LANES; ++lane) {
+        const auto a = splitmix();
+        const auto b = splitmix();
+        m_state[0][lane] = static_cast<std::uint32_t>(a);
+        m_state[1][lane] = static_cast<std::uint32_t>(a >> 32);
+        m_state[2][lane] = static_cast<std::uint32_t>(b);
+        m_state[3][lane] = static_cast<std::uint32_t>(b >> 32) | 1; // state can't be all zeros.
+    }
 
-//----------------------------------------------------------------------------
-void Utils::glfwFocusCallback(GLFWwindow *window, int inFocus)
-{
-    if(!inFocus)
-        glfwFocusWindow(window);
+    m_index = LANES;
 }
 
-//----------------------------------------------------------------------------
-void Utils::glfwMousePosCallback(GLFWwindow* window, double xpos, double ypos)
+//--------------------------------------------------------------------
+void Utils::FastNumberGenerator::step(float* values)
 {
-    static double x = -1;
-    static double y = -1;
-
-    if (x == -1) {
-        x = xpos;
-    }
-    if (y == -1) {
-        y = ypos;
-    }
-    if (x != xpos || y != ypos) {
-        glfwSetWindowShouldClose(window, GLFW_TRUE);
-    }
-}
+    for (int lane = 0; lane < LANES; ++lane) {
+        const std::uint32_t result = m_state[0][lane] + m_state[3][lane];
+        const std::uint32_t t = m_state[1][lane] << 9;
 
-//----------------------------------------------------------------------------
-void Utils::glfwMouseButtonCallback(GLFWwindow* window, int, int, int)
-{
-    glfwSetWindowShouldClose(window, GLFW_TRUE);
-}
+        m_state[2][lane] ^= m_state[0][lane];
+        m_state[3][lane] ^= m_state[1][lane];
+        m_state[1][lane] ^= m_state[2][lane];
+        m_state[0][lane] ^= m_state[3][lane];
+        m_state[2][lane] ^= t;
+        m_state[3][lane] = (m_state[3][lane] << 11) | (m_state[3][lane] >> 21);
 
-//----------------------------------------------------------------------------
-GLint Utils::loadShader(const char* source, GLenum type)
-{
-    GLuint shader;
-    shader = glCreateShader(type);
-    glShaderSource(shader, 1, (const GLchar**)&source, nullptr);
-    glCompileShader(shader);
-
-    GLint compiled;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
-    if (!compiled) {
-        const std::string shaderType =
-            type == GL_VERTEX_SHADER ? "Vertex" : (type == GL_FRAGMENT_SHADER ? "Fragment" : "Geometry");
-
-        GLint logLen = -1;
-        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLen);
-
-        char* logString = new char[logLen];
-        memset(logString, 0, logLen);
-        glGetShaderInfoLog(shader, logLen, nullptr, logString);
-
-        const std::string errorString =
-            shaderType + std::string(" shader compilation failed : ") + (logLen > 0 ? logString : "empty");
-        delete[] logString;
-
-        glDeleteShader(shader);
-        errorCallback(EXIT_FAILURE, errorString.c_str());
+        // Upper 24 bits to a float in [0,1).
+        values[lane] = m_min + m_range * (static_cast<float>(result >> 8) * 0x1.0p-24f);
     }
-
-    return shader;
 }
 
-//----------------------------------------------------------------------------
-void Utils::initProgram(GL_program& program, attribList attribs)
+//--------------------------------------------------------------------
+void Utils::FastNumberGenerator::fill(float* values, const std::size_t n)
 {
-    program.program = glCreateProgram();
+    std::size_t i = 0;
 
-    if (program.vert != static_cast<unsigned int>(-1)) {
-        glAttachShader(program.program, program.vert);
+    // Use the pending values first so get() and fill() share the same sequence.
+    for (; i < n && m_index < LANES; ++i) {
+        values[i] = m_values[m_index++];
     }
 
-    if (program.geom != static_cast<unsigned int>(-1)) {
-        glAttachShader(program.program, program.geom);
+    for (; i + LANES <= n; i += LANES) {
+        step(values + i);
     }
 
-    if (program.frag != static_cast<unsigned int>(-1)) {
-        glAttachShader(program.program, program.frag);
+    for (; i < n; ++i) {
+        values[i] = get();
     }
+}
 
-    for (auto& [pos, attribName] : attribs) {
-        glBindAttribLocation(program.program, pos, attribName.c_str());
+//--------------------------------------------------------------------
+void Utils::CounterNumberGenerator::fill(const std::uint64_t frame, const std::uint32_t first,
+                                         const std::uint32_t slot, float* values, const std::size_t n) const
+{
+    // A Philox block gives the slot of four consecutive streams.
+    std::size_t i = 0;
+    while (i < n) {
+        const auto index = first + static_cast<std::uint32_t>(i);
+        std::uint32_t c[4] = {index / 4, static_cast<std::uint32_t>(frame), static_cast<std::uint32_t>(frame >> 32),
+                              slot};
+        philox(c);
+
+        const auto lane = index % 4;
+        const auto count = std::min<std::size_t>(4 - lane, n - i);
+        for (std::size_t j = 0; j < count; ++j) {
+            values[i + j] = toFloat(c[lane + j]);
+        }
+        i += count;
     }
+}
 
-    glLinkProgram(program.program);
-
-    int linked;
-    glGetProgramiv(program.program, GL_LINK_STATUS, &linked);
-    if (!linked) {
-        GLint logLen;
-        glGetProgramiv(program.program, GL_INFO_LOG_LENGTH, &logLen);
-
-        char* logString = new char[logLen];
-        memset(logString, 0, logLen);
-        glGetProgramInfoLog(program.program, logLen, NULL, logString);
-        const std::string errorString =
-            std::string("GL program \"") + program.name + "\" link failed: " + (logLen > 0 ? logString : "empty");
-        delete[] logString;
-
-        glDeleteProgram(program.program);
-        errorCallback(EXIT_FAILURE, errorString.c_str());
+//--------------------------------------------------------------------
+void Utils::CounterNumberGenerator::gather(const std::uint64_t frame, const std::uint32_t* indexes,
+                                           const std::uint32_t slot, float* values, const std::size_t n) const
+{
+    for (std::size_t i = 0; i < n; ++i) {
+        values[i] = get(frame, indexes[i], slot);
     }
 }
 
-//----------------------------------------------------------------------------
-void Utils::saveScreenshotToFile(const std::string& filename, int windowWidth, int windowHeight)
+//--------------------------------------------------------------------
+Utils::NumberGenerator::NumberGenerator(const float min, const float max) :
+    NumberGenerator(min, max, static_cast<std::uint64_t>(std::time(0)))
 {
-    const int numberOfPixels = windowWidth * windowHeight * 3;
-    auto pixels = std::make_unique<std::vector<unsigned char>>(numberOfPixels);
-
-    glPixelStorei(GL_PACK_ALIGNMENT, 1);
-    glReadBuffer(GL_FRONT);
-    glReadPixels(0, 0, windowWidth, windowHeight, GL_BGR_EXT, GL_UNSIGNED_BYTE, pixels->data());
-
-    std::ofstream outputFile(filename.c_str(), std::ofstream::out);
-    short header[] = {0, 2, 0, 0, 0, 0, static_cast<short int>(windowWidth), static_cast<short int>(windowHeight), 24};
-    outputFile.write(reinterpret_cast<const char*>(header), sizeof(header));
-    outputFile.write(reinterpret_cast<const char*>(pixels->data()), numberOfPixels);
-    outputFile.close();
-
-    std::cout << "Finish writing to file: " << filename << std::endl;
 }
 
-//----------------------------------------------------------------------------
-std::wstring Utils::s2ws(const std::string& str)
+//--------------------------------------------------------------------
+Utils::NumberGenerator::NumberGenerator(const float min, const float max, const std::uint64_t seed) :
+    m_generator{min, max, seed}
 {
-    int size_needed = MultiByteToWideChar(CP_UTF8, 0, &str[0], (int)str.size(), NULL, 0);
-    std::wstring wstrTo(size_needed, 0);
-    MultiByteToWideChar(CP_UTF8, 0, &str[0], (int)str.size(), &wstrTo[0], size_needed);
-    return wstrTo;
 }
 
 //--------------------------------------------------------------------
-Utils::NumberGenerator::NumberGenerator(const float min, const float max) :
-    m_distribution{min, max}
+const float Utils::NumberGenerator::get()
 {
-    std::srand(std::time(0));
-    m_generator.discard(std::rand() % 200);
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_generator.get();
 }
 
 //--------------------------------------------------------------------
-const float Utils::NumberGenerator::get()
+void Utils::NumberGenerator::fill(float* values, const std::size_t n)
 {
     std::lock_guard<std::mutex> lock(m_mutex);
 
-    return m_distribution(m_generator);
+    m_generator.fill(values, n);
 }
 
 //--------------------------------------------------------------------
@@ -332,59 +222,29 @@ Utils::hsv Utils::rgb2hsv(Utils::rgb in)
 //--------------------------------------------------------------------
 Utils::rgb Utils::hsv2rgb(Utils::hsv in)
 {
-    float hh, p, q, t, ff;
-    long i;
     rgb out;
+    hsv2rgb(&in, &out, 1);
+    return out;
+}
 
-    if (in.s <= 0.0) { // < is bogus, just shuts up warnings
-        out.r = in.v;
-        out.g = in.v;
-        out.b = in.v;
-        return out;
-    }
-    hh = in.h;
-    if (hh >= 360.0) {
-        hh = 0.0;
-    }
-    hh /= 60.0;
-    i = static_cast<long>(hh);
-    ff = hh - i;
-    p = in.v * (1.0 - in.s);
-    q = in.v * (1.0 - (in.s * ff));
-    t = in.v * (1.0 - (in.s * (1.0 - ff)));
-
-    switch (i) {
-        case 0:
-            out.r = in.v;
-            out.g = t;
-            out.b = p;
-            break;
-        case 1:
-            out.r = q;
-            out.g = in.v;
-            out.b = p;
-            break;
-        case 2:
-            out.r = p;
-            out.g = in.v;
-            out.b = t;
-            break;
-        case 3:
-            out.r = p;
-            out.g = q;
-            out.b = in.v;
-            break;
-        case 4:
-            out.r = t;
-            out.g = p;
-            out.b = in.v;
-            break;
-        case 5:
-        default:
-            out.r = in.v;
-            out.g = p;
-            out.b = q;
-            break;
+//--------------------------------------------------------------------
+void Utils::hsv2rgb(const hsv* in, rgb* out, const std::size_t n)
+{
+    // Each component is v - v*s*f(k), with k the hue in sextants shifted by 5 (red), 3 (green) and 1 (blue) and
+    // f(k) = clamp(min(k, 4 - k), 0, 1) on k mod 6. It's the piecewise function of the hue sectors without
+    // branching, so the loop vectorizes. Float only, a single color gets the same bits as a batch.
+    auto component = [](const hsv& c, const float shift) {
+        const float hh = c.h >= 360.f ? 0.f : c.h / 60.f;
+        float k = hh + shift;
+        k = k >= 6.f ? k - 6.f : k;
+        const float f = std::max(0.f, std::min(std::min(k, 4.f - k), 1.f));
+        const float s = c.s <= 0.f ? 0.f : c.s;
+        return c.v - c.v * s * f;
+    };
+
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i].r = component(in[i], 5.f);
+        out[i].g = component(in[i], 3.f);
+        out[i].b = component(in[i], 1.f);
     }
-    return out;
 }
@@ -22,16 +22,169 @@
 
 // C++
 #include <iostream>
-#include <GL/gl.h>
-#include <list>
 #include <cmath>
+#include <cstdint>
 #include <random>
 #include <mutex>
-
-struct GLFWwindow;
+#include <new>
+#include <vector>
 
 namespace Utils
 {
+    /** \class FastNumberGenerator
+     * \brief Implements a xoshiro128+ random number generator of floats between the given limits. Runs eight
+     * interleaved streams so the batch generation vectorizes. It's not thread safe, use one instance per thread.
+     *
+     */
+    class FastNumberGenerator
+    {
+      public:
+        /** \brief FastNumberGenerator class constructor.
+         * \param[in] min lower limit.
+         * \param[in] max upper limit.
+         * \param[in] seed generator seed.
+         *
+         */
+        explicit FastNumberGenerator(const float min, const float max, const std::uint64_t seed);
+
+        /** \brief Re-seeds the generator.
+         * \param[in] seed generator seed.
+         *
+         */
+        void seed(const std::uint64_t seed);
+
+        /** \brief Returns a random number.
+         *
+         */
+        inline float get()
+        {
+            if (m_index == LANES) {
+                step(m_values);
+                m_index = 0;
+            }
+
+            return m_values[m_index++];
+        }
+
+        /** \brief Fills the given buffer with random numbers.
+         * \param[out] values buffer of at least n floats.
+         * \param[in] n number of values.
+         *
+         */
+        void fill(float* values, const std::size_t n);
+
+      private:
+        static const int LANES = 8; /** number of interleaved streams. */
+
+        /** \brief Advances the streams and writes one number of each to the given buffer.
+         * \param[out] values buffer of at least LANES floats.
+         *
+         */
+        void step(float* values);
+
+        alignas(32) std::uint32_t m_state[4][LANES]; /** xoshiro128+ states, one column per stream.   */
+        alignas(32) float m_values[LANES];           /** numbers generated and not returned yet.      */
+        int m_index;                                 /** next value of m_values to return.            */
+        float m_min;                                 /** lower limit.                                 */
+        float m_range;                               /** upper limit minus lower limit.               */
+    };
+
+    /** \class CounterNumberGenerator
+     * \brief Implements a Philox4x32-10 counter based random number generator of floats between the given limits.
+     * Each number is a function of (seed, frame, index, slot) only, so streams can be evaluated in any order and
+     * on any thread with the same results.
+     *
+     */
+    class CounterNumberGenerator
+    {
+      public:
+        /** \brief CounterNumberGenerator class constructor.
+         * \param[in] min lower limit.
+         * \param[in] max upper limit.
+         * \param[in] seed generator seed.
+         *
+         */
+        explicit CounterNumberGenerator(const float min, const float max, const std::uint64_t seed) :
+            m_key{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)},
+            m_min{min},
+            m_range{max - min} {};
+
+        /** \brief Returns the random number of the given slot of a stream. Streams are grouped by four, the slot
+         * of the group shares a Philox block and each stream takes one of its words.
+         * \param[in] frame frame number.
+         * \param[in] index stream index.
+         * \param[in] slot slot number.
+         *
+         */
+        inline float get(const std::uint64_t frame, const std::uint32_t index, const std::uint32_t slot) const
+        {
+            std::uint32_t c[4] = {index / 4, static_cast<std::uint32_t>(frame), static_cast<std::uint32_t>(frame >> 32),
+                                  slot};
+            philox(c);
+
+            return toFloat(c[index % 4]);
+        }
+
+        /** \brief Fills the given buffer with the random number of the given slot of consecutive streams.
+         * \param[in] frame frame number.
+         * \param[in] first index of the first stream.
+         * \param[in] slot slot number.
+         * \param[out] values buffer of at least n floats.
+         * \param[in] n number of streams.
+         *
+         */
+        void fill(const std::uint64_t frame, const std::uint32_t first, const std::uint32_t slot, float* values,
+                  const std::size_t n) const;
+
+        /** \brief Fills the given buffer with the random number of the given slot of the given streams.
+         * \param[in] frame frame number.
+         * \param[in] indexes stream indexes.
+         * \param[in] slot slot number.
+         * \param[out] values buffer of at least n floats.
+         * \param[in] n number of streams.
+         *
+         */
+        void gather(const std::uint64_t frame, const std::uint32_t* indexes, const std::uint32_t slot, float* values,
+                    const std::size_t n) const;
+
+        /** \brief Applies the ten Philox4x32 rounds to the given counter in place, with the seed as the key. Public
+         * for the known-answer tests, get() and fill() build the counter of a stream.
+         * \param[inout] c counter, the random words on return.
+         *
+         */
+        inline void philox(std::uint32_t* c) const
+        {
+            std::uint32_t k[2] = {m_key[0], m_key[1]};
+
+            for (int round = 0; round < 10; ++round) {
+                const std::uint64_t p0 = static_cast<std::uint64_t>(0xD2511F53u) * c[0];
+                const std::uint64_t p1 = static_cast<std::uint64_t>(0xCD9E8D57u) * c[2];
+                const std::uint32_t r[4] = {static_cast<std::uint32_t>(p1 >> 32) ^ c[1] ^ k[0],
+                                            static_cast<std::uint32_t>(p1),
+                                            static_cast<std::uint32_t>(p0 >> 32) ^ c[3] ^ k[1],
+                                            static_cast<std::uint32_t>(p0)};
+                c[0] = r[0];
+                c[1] = r[1];
+                c[2] = r[2];
+                c[3] = r[3];
+                k[0] += 0x9E3779B9u;
+                k[1] += 0xBB67AE85u;
+            }
+        }
+
+      private:
+        /** \brief Returns the float between the limits of the upper 24 bits of the given word.
+         * \param[in] word random word.
+         *
+         */
+        inline float toFloat(const std::uint32_t word) const
+        { return m_min + m_range * (static_cast<float>(word >> 8) * 0x1.0p-24f); }
+
+        std::uint32_t m_key[2]; /** Philox key, the seed.          */
+        float m_min;            /** lower limit.                   */
+        float m_range;          /** upper limit minus lower limit. */
+    };
+
     /** \class NumberGenerator
      * \brief Implements a shared random number generator between the given limits.
      *
@@ -46,17 +199,91 @@ namespace Utils
          */
         explicit NumberGenerator(const float min, const float max);
 
+        /** \brief NumberGenerator class constructor with an explicit seed, for reproducible runs.
+         * \param[in] min lower limit.
+         * \param[in] max upper limit.
+         * \param[in] seed generator seed.
+         *
+         */
+        explicit NumberGenerator(const float min, const float max, const std::uint64_t seed);
+
         /** \brief Returns a random number.
          *
          */
         const float get();
 
+        /** \brief Fills the given buffer with random numbers, taking the lock only once.
+         * \param[out] values buffer of at least n floats.
+         * \param[in] n number of values.
+         *
+         */
+        void fill(float* values, const std::size_t n);
+
       private:
-        std::default_random_engine m_generator;                /** random number generator.               */
-        std::uniform_real_distribution<double> m_distribution; /** uniform real distribution in [min,max] */
-        std::mutex m_mutex;                                    /** mutex                                  */
+        FastNumberGenerator m_generator; /** random number generator. */
+        std::mutex m_mutex;              /** mutex                    */
+    };
+
+    /** \class AlignedAllocator
+     * \brief Allocator that returns memory aligned to the given boundary, used for the SoA particle arrays.
+     *
+     */
+    template <typename T, std::size_t Alignment = 64>
+    class AlignedAllocator
+    {
+      public:
+        using value_type = T;
+
+        template <typename U>
+        struct rebind
+        {
+            using other = AlignedAllocator<U, Alignment>;
+        };
+
+        AlignedAllocator() noexcept = default;
+
+        template <typename U>
+        AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept
+        {
+        }
+
+        /** \brief Allocates memory for n elements.
+         * \param[in] n number of elements.
+         *
+         */
+        T* allocate(const std::size_t n)
+        {
+            // Round up to whole alignment blocks so vector loops can read past the last element.
+            const auto bytes = ((n * sizeof(T) + Alignment - 1) / Alignment) * Alignment;
+            return static_cast<T*>(::operator new(bytes, std::align_val_t(Alignment)));
+        }
+
+        /** \brief Frees the memory of the given pointer.
+         * \param[in] p pointer to free.
+         *
+         */
+        void deallocate(T* p, const std::size_t) noexcept
+        {
+            ::operator delete(p, std::align_val_t(Alignment));
+        }
+
+        template <typename U>
+        bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept
+        {
+            return true;
+        }
+
+        template <typename U>
+        bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept
+        {
+            return false;
+        }
     };
 
+    // Vector with aligned storage.
+    template <typename T>
+    using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
     /** \struct rgb
      * \brief Contains the red/green/blue color values.
      */
@@ -106,33 +333,22 @@ namespace Utils
      */
     hsv rgb2hsv(rgb in);
 
-    /** \brief Converts hsv to rgb
+    /** \brief Converts hsv to rgb, a batch of one color.
      *
      */
     rgb hsv2rgb(hsv in);
 
-    /** \struct GL_program
-     * \brief Contains a gl program. 
+    /** \brief Converts the given hsv colors to rgb in float, without branching on the hue sector so the loop
+     * vectorizes. Each color gets the same bits as with hsv2rgb(hsv).
+     * \param[in] in hsv colors.
+     * \param[out] out rgb colors, at least n.
+     * \param[in] n number of colors.
      *
      */
-    struct GL_program
-    {
-        std::string name;
-        unsigned int vert;
-        unsigned int geom;
-        unsigned int frag;
-        unsigned int program;
-
-        /** \brief GL_program struct constructor.
-         * \param[in] n Program name.
-         */
-        GL_program(const std::string& n) :
-            name{n},
-            vert{static_cast<unsigned int>(-1)},
-            geom{static_cast<unsigned int>(-1)},
-            frag{static_cast<unsigned int>(-1)},
-            program{static_cast<unsigned int>(-1)} {};
-    };
+    void hsv2rgb(const hsv* in, rgb* out, const std::size_t n);
+
+    static const int MAX_TRAIL_LENGTH = 32; /** maximum number of segments of the trails.        */
+    static const float BLUR_DECAY = 0.75f;  /** fraction of the colors kept by the motion blur. */
 
     /** \struct Configuration
      * \brief Configuration data struct.
@@ -144,6 +360,10 @@ namespace Utils
         bool show_trails;            /** true to show the particle trails and false otherwise. */
         bool motion_blur;            /** true to use motion blur and false otherwise.          */
         unsigned int pixelsPerPoint; /** pixels per point computation.                         */
+        bool packed_vertices;        /** true to upload quantized vertices, false for floats.  */
+        bool instanced_trails;       /** true to draw trails as instanced quads.               */
+        unsigned int trail_length;   /** number of segments of the trails, one per frame.      */
+        unsigned int blur_scale;     /** divisor of the motion blur resolution: 1, 2 or 4.     */
 
         /** \brief Configuration constructor. 
          *
@@ -153,7 +373,11 @@ namespace Utils
             antialias{true},
             show_trails{true},
             motion_blur{false},
-            pixelsPerPoint{1000} {};
+            pixelsPerPoint{1000},
+            packed_vertices{true},
+            instanced_trails{false},
+            trail_length{1},
+            blur_scale{1} {};
     };
 
     /** \brief Dump Configuration information, for debugging purposes.
@@ -163,77 +387,6 @@ namespace Utils
      */
     std::ostream& operator<<(std::ostream& os, const struct Configuration& config);
 
-    /** \brief Loads the application configuration from the windows registry. 
-     * \param[out] config Configuration struct reference. 
-     *
-     */
-    void loadConfiguration(Configuration& config);
-
-    /** \brief Saves the application configuration to the windows registry. 
-     * \param[in] config Configuration struct reference. 
-     *
-     */
-    void saveConfiguration(const Configuration& config);
-
-    /** \brief Helper method to convert a string to a wide-char string.
-     * \param[in] str String reference. 
-     *
-     */
-    std::wstring s2ws(const std::string& str);
-
-    /** \brief  Error callback for errors.
-     * \param error Error code.
-     * \param description Error description.
-     *
-     */
-    void errorCallback(int error, const char* description);
-
-    /** \brief Key callback for glfw key processing.
-     * \param[in] window GLFW window pointer.
-     *
-     */
-    void glfwKeyCallback(GLFWwindow* window, int /* key */, int /* scancode */, int /* action */, int /* mods */);
-
-    /** \brief Mouse movement callback for glfw.
-     * \param[in] window GLFW window pointer.
-     *
-     */
-    void glfwMousePosCallback(GLFWwindow* window, double /* xpos */, double /* ypos */);
-
-    /** \brief Mouse buttons callback for glfw.
-    * \param[in] window GLFW window pointer.
-    *
-    */
-    void glfwMouseButtonCallback(GLFWwindow* window, int /* button */, int /* action */, int /* mods */);
-
-    /** void \brief GLFW focus callback.
-    * \param[in] window GLFW window pointer.
-    * \param[in] inFocus True if the window is in focus, and false otherwise. 
-    *
-    */
-    void glfwFocusCallback(GLFWwindow *window, int inFocus);
-
-    /** \brief Helper method to load the shader and check for errors.
-     * \param[in] source Shader source code.
-     * \param[in] type Shader type: vertex, fragment.
-     *
-     */
-    GLint loadShader(const char* source, GLenum type);
-
-    // List of attribute bind positions and names.
-    using attribList = std::list<std::pair<GLuint, const std::string>>;
-
-    /** \brief Helper method to compile the program and check for errors.
-     * \param[inout] program GL program struct reference.
-     */
-    void initProgram(GL_program& program, attribList attribs = attribList());
-
-    /** \brief Helper method to save the current framebuffer to a TGA file.
-     * \param[in] windowWidth Width in pixels of the framebuffer.
-     * \param[in] windowHeight Height in pixels of the framebuffer. 
-     *
-     */
-    void saveScreenshotToFile(const std::string& filename, int windowWidth, int windowHeight);
 } // namespace Utils
 
 #endif // _UTILS_H_
@@ -20,20 +20,27 @@
 // Project
 #include <WhirlWindWarp.h>
 
+// C++
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+
+//--------------------------------------------------------------------
+WhirlWindWarp::WhirlWindWarp(const int numPoints, const Utils::Configuration& config) :
+    WhirlWindWarp(numPoints, config, static_cast<std::uint64_t>(std::time(0)))
+{
+}
+
 //--------------------------------------------------------------------
-WhirlWindWarp::WhirlWindWarp(const int numPoints, const Utils::Configuration& config,
-                             Utils::NumberGenerator* generator) :
-    m_generator{generator},
+WhirlWindWarp::WhirlWindWarp(const int numPoints, const Utils::Configuration& config, const std::uint64_t seed) :
+    m_seed{seed},
+    m_generator{std::make_unique<Utils::NumberGenerator>(-1.f, 1.f, seed)},
     m_particles{nullptr},
     m_config{config}
 {
     m_state.initted = false;
     m_state.numPoints = numPoints;
 
-    if (!generator) {
-        m_generator = new Utils::NumberGenerator(-1.f, 1.f);
-    }
-
     init();
 }
 
@@ -42,9 +49,40 @@ void WhirlWindWarp::advance()
 {
     preUpdateState();
 
+    if (m_recorder) {
+        m_recorder->write(m_state);
+    }
+
     m_particles->advance();
 
-    postUpdateState();
+    // The trace already has the state of the next frame.
+    if (!m_replay) {
+        postUpdateState();
+    }
+}
+
+//--------------------------------------------------------------------
+bool WhirlWindWarp::startRecording(const std::string& filename)
+{
+    m_recorder = std::make_unique<StateTrace::Writer>(filename, m_seed, m_state.numPoints);
+    if (!m_recorder->isOpen()) {
+        m_recorder = nullptr;
+        return false;
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------
+bool WhirlWindWarp::startReplay(const std::string& filename)
+{
+    m_replay = std::make_unique<StateTrace::Reader>(filename);
+    if (!m_replay->isOpen() || m_replay->seed() != m_seed || m_replay->numPoints() != m_state.numPoints) {
+        m_replay = nullptr;
+        return false;
+    }
+
+    return true;
 }
 
 //--------------------------------------------------------------------
@@ -133,7 +171,7 @@ void WhirlWindWarp::init()
     m_state.hue = 180 + 180 * m_generator->get();
 
     if (!m_particles) {
-        m_particles = std::make_unique<Particles>(m_state, m_generator, m_config);
+        m_particles = std::make_unique<Particles>(m_state, m_generator.get(), m_config);
     }
 }
 
@@ -145,6 +183,57 @@ void WhirlWindWarp::preUpdateState()
     if (!m_state.initted) {
         init();
     }
+
+    if (m_replay && !m_replay->read(m_state)) {
+        m_replay = nullptr;
+    }
+
+    composeAffineFields(m_state);
+}
+
+//--------------------------------------------------------------------
+void WhirlWindWarp::composeAffineFields(State& state)
+{
+    // Composed in double precision in the same order the fields were applied one after another.
+    double m[6] = {1, 0, 0, 0, 1, 0};
+
+    // Applies the transform (a*x + b*y + c, d*x + e*y + f) after the current one.
+    auto then = [&m](const double a, const double b, const double c, const double d, const double e, const double f) {
+        const double r[6] = {a * m[0] + b * m[3], a * m[1] + b * m[4], a * m[2] + b * m[5] + c,
+                             d * m[0] + e * m[3], d * m[1] + e * m[4], d * m[2] + e * m[5] + f};
+        std::copy(r, r + 6, m);
+    };
+
+    const auto& var = state.var;
+
+    /* Warping in/out */
+    if (state.enabled[1]) {
+        then(var[1], 0, 0, 0, var[1], 0);
+    }
+
+    /* Rotation */
+    if (state.enabled[2]) {
+        const auto c = std::cos(1.1 * var[2]);
+        const auto s = std::sin(1.1 * var[2]);
+        then(c, s, 0, -s, c, 0);
+    }
+
+    /* Horizontal asymptote */
+    if (state.enabled[3]) {
+        then(1, 0, 0, 0, var[3], 0);
+    }
+
+    /* Vertical asymptote */
+    if (state.enabled[4]) {
+        then(1.0 + var[4], 0, 0, 0, 1, 0);
+    }
+
+    /* Vertical asymptote at right of screen */
+    if (state.enabled[5]) {
+        then(var[5], 0, 1.0 - var[5], 0, 1, 0);
+    }
+
+    std::copy(m, m + 6, state.affine);
 }
 
 //--------------------------------------------------------------------
@@ -186,7 +275,7 @@ void WhirlWindWarp::postUpdateState()
     // BUG: Picking randomly might not be enough since 0,11,12,14 and 15 do nothing!
     // But then what's wrong with a rare gentle twinkle?!
     while (numEnabled < 3) {
-        auto index = std::rand() % fs;
+        const auto index = std::min(fs - 1, static_cast<int>((m_generator->get() + 1.f) * 0.5f * fs));
         if (m_state.enabled[index]) {
             continue;
         }
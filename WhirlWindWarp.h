@@ -21,17 +21,14 @@
 #define WHIRLWINDWARP_H_
 
 #include <Particle.h>
+#include <StateTrace.h>
 #include <Utils.h>
 
 // C++
+#include <cstdint>
 #include <memory>
 #include <string>
 
-namespace Utils
-{
-    class NumberGenerator;
-}
-
 static const int fs = 16; /** number of forcefields.    */
 
 /** \struct State
@@ -50,6 +47,7 @@ struct State
     bool initted;           /** true if inited and false otherwise.              */
     bool changedColor;      /** true if changed a point color in the last frame. */
     int hue;                /** hue value.                                       */
+    float affine[6];        /** Composition of the affine fields (1 to 5).       */
 };
 
 /** \class WindWhirlWarp
@@ -59,14 +57,21 @@ struct State
 class WhirlWindWarp
 {
   public:
-    /** \brief WindWhirlWarp class constructor.
+    /** \brief WindWhirlWarp class constructor. Seeds the simulation with the current time.
+     * \param[in] numPoints total number of points.
+     * \param[in] config application configuration.
+     *
+     */
+    explicit WhirlWindWarp(const int numPoints, const Utils::Configuration& config);
+
+    /** \brief WindWhirlWarp class constructor with an explicit seed. Two simulations with the same seed, number of
+     * points and configuration produce the same frames.
      * \param[in] numPoints total number of points.
      * \param[in] config application configuration.
-     * \param[in] generator random number generator class pointer.
+     * \param[in] seed simulation seed.
      *
      */
-    explicit WhirlWindWarp(const int numPoints, const Utils::Configuration& config,
-                           Utils::NumberGenerator* generator = nullptr);
+    explicit WhirlWindWarp(const int numPoints, const Utils::Configuration& config, const std::uint64_t seed);
 
     /** \brief Updates the state and calls advance() on the scene.
      * \param[in] time_ Current time.
@@ -74,14 +79,60 @@ class WhirlWindWarp
      */
     void advance();
 
-    /** \brief Returns the buffer to use in OpenGL
+    /** \brief Returns the particles, to upload them in separate streams.
+     *
+     */
+    inline Particles& particles()
+    {
+        return *m_particles;
+    }
+
+    /** \brief Returns the state of the simulation, the force fields of the next frame unless replaying.
      *
      */
-    inline const float* buffer() const
+    inline const State& state() const
     {
-        return m_particles->buffer();
+        return m_state;
     }
 
+    /** \brief Returns the seed of the simulation.
+     *
+     */
+    inline std::uint64_t seed() const
+    {
+        return m_seed;
+    }
+
+    /** \brief Starts writing the state of every following frame to the given trace file. Returns false if the file
+     * can't be created.
+     * \param[in] filename trace file name.
+     *
+     */
+    bool startRecording(const std::string& filename);
+
+    /** \brief Starts driving the force fields from the given trace file instead of the random schedule. Returns false
+     * if the file can't be read or wasn't recorded with the seed and number of points of this simulation. When the
+     * trace ends the simulation continues with the random schedule.
+     * \param[in] filename trace file name.
+     *
+     */
+    bool startReplay(const std::string& filename);
+
+    /** \brief Returns true if the force fields are being driven from a trace file.
+     *
+     */
+    inline bool replaying() const
+    {
+        return m_replay != nullptr;
+    }
+
+    /** \brief Composes the enabled affine fields (warp, rotation and asymptotes) of the given state into its
+     * matrix. The point (x,y) is transformed to (a0*x + a1*y + a2, a3*x + a4*y + a5).
+     * \param[inout] state simulation state.
+     *
+     */
+    static void composeAffineFields(State& state);
+
   private:
     /** \brief Initializes the particles buffer. 
      *
@@ -112,10 +163,13 @@ class WhirlWindWarp
      */
     float stars_perturb(float var, float op, float damp, float force);
 
-    Utils::NumberGenerator* m_generator;    /** random number generator in [-1,1]. */
-    struct State m_state;                   /** application state.                 */
-    std::unique_ptr<Particles> m_particles; /** particles                          */
-    const Utils::Configuration& m_config;   /** application configuration.         */
+    const std::uint64_t m_seed;                         /** simulation seed.                   */
+    std::unique_ptr<Utils::NumberGenerator> m_generator; /** random number generator in [-1,1]. */
+    struct State m_state;                               /** application state.                 */
+    std::unique_ptr<Particles> m_particles;             /** particles                          */
+    const Utils::Configuration& m_config;               /** application configuration.         */
+    std::unique_ptr<StateTrace::Writer> m_recorder;     /** trace recorder, if recording.      */
+    std::unique_ptr<StateTrace::Reader> m_replay;       /** trace reader, if replaying.        */
 };
 
 #endif // WHIRLWINDWARP_H_
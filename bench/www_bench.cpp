@@ -0,0 +1,241 @@
+/*
+ File: www_bench.cpp
+ Created on: 17/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <SoftwareRenderer.h>
+#include <StateTrace.h>
+#include <Utils.h>
+#include <WhirlWindWarp.h>
+
+// C++
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace
+{
+    /** \struct Options
+     * \brief Benchmark command line options.
+     *
+     */
+    struct Options
+    {
+        int points;         /** number of particles.                         */
+        int frames;         /** number of measured frames.                   */
+        int warmup;         /** number of frames advanced before timing.     */
+        std::uint64_t seed; /** random number generator seed.                */
+        bool trails;        /** true to draw the trails, only with --render. */
+        int width;          /** software rendering width, 0 to not render.   */
+        int height;         /** software rendering height, 0 to not render.  */
+        std::string record; /** trace file to record, empty if none.         */
+        std::string replay; /** trace file to replay, empty if none.         */
+
+        /** \brief Options struct constructor.
+         *
+         */
+        Options() :
+            points{100000},
+            frames{1000},
+            warmup{50},
+            seed{1},
+            trails{true},
+            width{0},
+            height{0},
+            record{},
+            replay{} {};
+    };
+
+    /** \brief Prints the usage to the standard error.
+     *
+     */
+    void usage()
+    {
+        std::cerr << "Usage: www_bench [--points N] [--frames N] [--warmup N] [--seed N] [--trails on|off]\n"
+                  << "                 [--render WIDTHxHEIGHT] [--record FILE | --replay FILE]\n"
+                  << "  --points  number of particles in [1000, 1000000], default 100000.\n"
+                  << "  --frames  number of measured frames, default 1000.\n"
+                  << "  --warmup  number of frames advanced before measuring, default 50.\n"
+                  << "  --seed    random number generator seed, default 1.\n"
+                  << "  --trails  draw the particle trails on or off with --render, default on. The simulation\n"
+                  << "            keeps the trail history anyway, so it has no effect without --render.\n"
+                  << "  --render  also draws every frame with the software renderer at the given size.\n"
+                  << "  --record  writes the force field state of every frame to the given trace file.\n"
+                  << "  --replay  drives the force fields from the given trace file, the seed and the number of\n"
+                  << "            points are taken from the trace.\n"
+                  << "The results are written to the standard output in JSON." << std::endl;
+    }
+
+    /** \brief Parses the command line into the given options, returns false on error.
+     * \param[in] argc number of arguments.
+     * \param[in] argv arguments.
+     * \param[out] options parsed options.
+     *
+     */
+    bool parse(int argc, char* argv[], Options& options)
+    {
+        for (int i = 1; i < argc; i += 2) {
+            const std::string name = argv[i];
+            if (i + 1 >= argc) {
+                return false;
+            }
+
+            const std::string value = argv[i + 1];
+            if (name == "--points") {
+                options.points = std::atoi(value.c_str());
+            } else if (name == "--frames") {
+                options.frames = std::atoi(value.c_str());
+            } else if (name == "--warmup") {
+                options.warmup = std::atoi(value.c_str());
+            } else if (name == "--seed") {
+                options.seed = std::strtoull(value.c_str(), nullptr, 10);
+            } else if (name == "--trails") {
+                if (value != "on" && value != "off") {
+                    return false;
+                }
+                options.trails = (value == "on");
+            } else if (name == "--render") {
+                if (std::sscanf(value.c_str(), "%dx%d", &options.width, &options.height) != 2 || options.width <= 0 ||
+                    options.height <= 0) {
+                    return false;
+                }
+            } else if (name == "--record") {
+                options.record = value;
+            } else if (name == "--replay") {
+                options.replay = value;
+            } else {
+                return false;
+            }
+        }
+
+        if (!options.record.empty() && !options.replay.empty()) {
+            return false;
+        }
+
+        if (!options.replay.empty()) {
+            const StateTrace::Reader trace(options.replay);
+            if (!trace.isOpen()) {
+                std::cerr << "Invalid trace file: " << options.replay << std::endl;
+                return false;
+            }
+
+            options.seed = trace.seed();
+            options.points = trace.numPoints();
+        }
+
+        return options.points >= 1000 && options.points <= 1000000 && options.frames > 0 && options.warmup >= 0;
+    }
+
+    /** \brief Returns the given percentile of the sorted values, nearest rank.
+     * \param[in] sorted values in increasing order.
+     * \param[in] percentile percentile in [0, 100].
+     *
+     */
+    double percentile(const std::vector<double>& sorted, const double percentile)
+    {
+        const auto rank = static_cast<std::size_t>(percentile / 100.0 * (sorted.size() - 1) + 0.5);
+        return sorted[std::min(rank, sorted.size() - 1)];
+    }
+} // namespace
+
+//--------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!parse(argc, argv, options)) {
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    Utils::Configuration config;
+    config.show_trails = options.trails;
+
+    WhirlWindWarp www(options.points, config, options.seed);
+
+    if (!options.record.empty() && !www.startRecording(options.record)) {
+        std::cerr << "Unable to create trace file: " << options.record << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (!options.replay.empty() && !www.startReplay(options.replay)) {
+        std::cerr << "Unable to replay trace file: " << options.replay << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::unique_ptr<SoftwareRenderer> renderer;
+    if (options.width > 0) {
+        renderer = std::make_unique<SoftwareRenderer>(options.width, options.height, config);
+    }
+
+    for (int i = 0; i < options.warmup; ++i) {
+        www.advance();
+        if (renderer) {
+            renderer->render(www.particles());
+        }
+    }
+
+    std::vector<double> times(options.frames);
+    for (auto& time : times) {
+        const auto start = std::chrono::steady_clock::now();
+        www.advance();
+        if (renderer) {
+            renderer->render(www.particles());
+        }
+        const auto end = std::chrono::steady_clock::now();
+        time = std::chrono::duration<double, std::nano>(end - start).count();
+    }
+
+    const double total = std::accumulate(times.cbegin(), times.cend(), 0.0);
+    const double mean = total / options.frames;
+    std::sort(times.begin(), times.end());
+
+    auto ms = [](const double ns) { return ns / 1e6; };
+    const std::string size = std::to_string(options.width) + "x" + std::to_string(options.height);
+    const std::string render = renderer ? "\"" + size + "\"" : "false";
+
+    std::cout << "{\n"
+              << "  \"benchmark\": \"www_bench\",\n"
+              << "  \"points\": " << options.points << ",\n"
+              << "  \"frames\": " << options.frames << ",\n"
+              << "  \"warmup\": " << options.warmup << ",\n"
+              << "  \"seed\": " << options.seed << ",\n"
+              << "  \"trails\": " << (renderer && options.trails ? "true" : "false") << ",\n"
+              << "  \"render\": " << render << ",\n"
+              << "  \"replay\": " << (options.replay.empty() ? "false" : "true") << ",\n"
+              << "  \"ns_per_particle_frame\": " << mean / options.points << ",\n"
+              << "  \"fps\": " << 1e9 / mean << ",\n"
+              << "  \"frame_ms\": {\n"
+              << "    \"mean\": " << ms(mean) << ",\n"
+              << "    \"min\": " << ms(times.front()) << ",\n"
+              << "    \"p50\": " << ms(percentile(times, 50)) << ",\n"
+              << "    \"p90\": " << ms(percentile(times, 90)) << ",\n"
+              << "    \"p99\": " << ms(percentile(times, 99)) << ",\n"
+              << "    \"max\": " << ms(times.back()) << "\n"
+              << "  }\n"
+              << "}" << std::endl;
+
+    return EXIT_SUCCESS;
+}
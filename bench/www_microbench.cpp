@@ -0,0 +1,612 @@
+/*
+ File: www_microbench.cpp
+ Created on: 17/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <Kernels.h>
+#include <Particle.h>
+#include <Utils.h>
+#include <WhirlWindWarp.h>
+
+// C++
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    static const int COUNTERS = 4; /** number of hardware counters. */
+
+    const char* COUNTER_NAMES[COUNTERS] = {"cycles", "instructions", "cache_misses", "branch_misses"};
+
+    /** \class Counters
+     * \brief Hardware performance counters of the calling thread, read as a group with perf_event_open. Not
+     * available outside Linux or if the kernel doesn't allow it, then only the time is measured.
+     *
+     */
+    class Counters
+    {
+      public:
+        /** \brief Counters class constructor.
+         *
+         */
+        Counters() :
+            m_fd{-1, -1, -1, -1}
+        {
+#ifdef __linux__
+            const std::uint64_t configs[COUNTERS] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                                     PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+
+            for (int i = 0; i < COUNTERS; ++i) {
+                perf_event_attr attr;
+                std::memset(&attr, 0, sizeof(attr));
+                attr.size = sizeof(attr);
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = configs[i];
+                attr.disabled = (i == 0);
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_GROUP;
+
+                m_fd[i] = syscall(__NR_perf_event_open, &attr, 0, -1, m_fd[0], 0);
+                if (m_fd[i] == -1) {
+                    close();
+                    return;
+                }
+            }
+#endif
+        }
+
+        /** \brief Counters class destructor.
+         *
+         */
+        ~Counters()
+        {
+            close();
+        }
+
+        /** \brief Returns true if the hardware counters can be read.
+         *
+         */
+        bool available() const
+        {
+            return m_fd[0] != -1;
+        }
+
+        /** \brief Resets and starts the counters.
+         *
+         */
+        void start()
+        {
+#ifdef __linux__
+            if (available()) {
+                ioctl(m_fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+                ioctl(m_fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+            }
+#endif
+        }
+
+        /** \brief Stops the counters and writes their values.
+         * \param[out] values counter values, zero if not available.
+         *
+         */
+        void stop(std::uint64_t* values)
+        {
+            std::fill(values, values + COUNTERS, 0);
+#ifdef __linux__
+            if (available()) {
+                ioctl(m_fd[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+                // PERF_FORMAT_GROUP layout: number of counters followed by their values.
+                std::uint64_t data[COUNTERS + 1];
+                if (read(m_fd[0], data, sizeof(data)) == sizeof(data)) {
+                    std::copy(data + 1, data + 1 + COUNTERS, values);
+                }
+            }
+#endif
+        }
+
+      private:
+        /** \brief Closes the opened counters.
+         *
+         */
+        void close()
+        {
+#ifdef __linux__
+            for (auto& fd : m_fd) {
+                if (fd != -1) {
+                    ::close(fd);
+                }
+                fd = -1;
+            }
+#endif
+        }
+
+        int m_fd[COUNTERS]; /** counter file descriptors, the first one is the group leader. */
+    };
+
+    /** \struct Benchmark
+     * \brief A benchmark runs a fixed number of operations of a single function on each call.
+     *
+     */
+    struct Benchmark
+    {
+        std::string name;          /** benchmark name.                    */
+        int operations;            /** number of operations of each call. */
+        std::function<void()> run; /** runs the operations once.          */
+    };
+
+    /** \struct Result
+     * \brief Median of the repeated measures of a benchmark, per operation.
+     *
+     */
+    struct Result
+    {
+        std::string name;          /** benchmark name.                                            */
+        double ns;                 /** nanoseconds per operation.                                 */
+        double spread;             /** (slowest - fastest) / median of the repeats, the noise.    */
+        double counters[COUNTERS]; /** counter values per operation, zero if unavailable.         */
+    };
+
+    /** \struct Reference
+     * \brief Baseline of a benchmark.
+     *
+     */
+    struct Reference
+    {
+        double ns;     /** nanoseconds per operation.                   */
+        double spread; /** noise of the baseline measure, see Result. */
+    };
+
+    /** \struct Options
+     * \brief Microbenchmark command line options.
+     *
+     */
+    struct Options
+    {
+        std::string filter;   /** only run the benchmarks containing this text.     */
+        std::string baseline; /** baseline file to compare with, empty for none.    */
+        std::string save;     /** file to save the results as baseline, or empty.   */
+        double threshold;     /** maximum allowed slowdown over the baseline.       */
+        double minTime;       /** minimum measured time of each benchmark, seconds. */
+        int repeats;          /** measures of each benchmark, the median is kept.   */
+
+        /** \brief Options struct constructor.
+         *
+         */
+        Options() :
+            threshold{0.1},
+            minTime{0.2},
+            repeats{5} {};
+    };
+
+    static const int PARTICLES = 8192; /** particles of the kernel benchmarks, a Particles chunk. */
+
+    volatile float sink; /** keeps the results of the benchmarks that only return a value. */
+
+    /** \brief Prints the usage to the standard error.
+     *
+     */
+    void usage()
+    {
+        std::cerr << "Usage: www_microbench [--filter TEXT] [--baseline FILE] [--save FILE] [--threshold F]"
+                  << " [--time S] [--repeats N]\n"
+                  << "  --filter     only run the benchmarks whose name contains TEXT.\n"
+                  << "  --baseline   compare with the ns/op of this machine in a saved baseline, fail if slower.\n"
+                  << "  --save       save the results as the baseline of this machine, keeping the other machines.\n"
+                  << "  --threshold  allowed slowdown over the baseline, default 0.1 (10%), the noise of both\n"
+                  << "               measures is added to it.\n"
+                  << "  --time       minimum measured time of each benchmark in seconds, default 0.2.\n"
+                  << "  --repeats    measures of each benchmark, the median is reported, default 5.\n"
+                  << "Baselines are keyed by CPU model and instruction set, a machine without its own baseline\n"
+                  << "isn't compared. The results are written to the standard output in JSON." << std::endl;
+    }
+
+    /** \brief Parses the command line into the given options, returns false on error.
+     * \param[in] argc number of arguments.
+     * \param[in] argv arguments.
+     * \param[out] options parsed options.
+     *
+     */
+    bool parse(int argc, char* argv[], Options& options)
+    {
+        for (int i = 1; i < argc; i += 2) {
+            const std::string name = argv[i];
+            if (i + 1 >= argc) {
+                return false;
+            }
+
+            const std::string value = argv[i + 1];
+            if (name == "--filter") {
+                options.filter = value;
+            } else if (name == "--baseline") {
+                options.baseline = value;
+            } else if (name == "--save") {
+                options.save = value;
+            } else if (name == "--threshold") {
+                options.threshold = std::atof(value.c_str());
+            } else if (name == "--time") {
+                options.minTime = std::atof(value.c_str());
+            } else if (name == "--repeats") {
+                options.repeats = std::atoi(value.c_str());
+            } else {
+                return false;
+            }
+        }
+
+        return options.threshold >= 0 && options.minTime > 0 && options.repeats > 0;
+    }
+
+    /** \brief Runs the benchmark until the minimum time has passed and returns the fastest call.
+     * \param[in] benchmark benchmark to run.
+     * \param[in] counters hardware counters.
+     * \param[in] minTime minimum measured time in seconds.
+     *
+     */
+    Result measure(const Benchmark& benchmark, Counters& counters, const double minTime)
+    {
+        Result result{benchmark.name, 0, 0, {0}};
+
+        // Warm up the caches and the branch predictors.
+        benchmark.run();
+
+        double best = -1;
+        double total = 0;
+        for (int calls = 0; total < minTime * 1e9 || calls < 5; ++calls) {
+            std::uint64_t values[COUNTERS];
+            counters.start();
+            const auto start = std::chrono::steady_clock::now();
+            benchmark.run();
+            const auto end = std::chrono::steady_clock::now();
+            counters.stop(values);
+
+            const double ns = std::chrono::duration<double, std::nano>(end - start).count();
+            total += ns;
+
+            if (best < 0 || ns < best) {
+                best = ns;
+                for (int i = 0; i < COUNTERS; ++i) {
+                    result.counters[i] = static_cast<double>(values[i]) / benchmark.operations;
+                }
+            }
+        }
+
+        result.ns = best / benchmark.operations;
+        return result;
+    }
+
+    /** \brief Measures the benchmark the given number of times and returns the median measure, with the spread
+     * of the measures as its noise.
+     * \param[in] benchmark benchmark to run.
+     * \param[in] counters hardware counters.
+     * \param[in] minTime minimum measured time of each measure in seconds.
+     * \param[in] repeats number of measures.
+     *
+     */
+    Result measureMedian(const Benchmark& benchmark, Counters& counters, const double minTime, const int repeats)
+    {
+        std::vector<Result> measures;
+        for (int i = 0; i < repeats; ++i) {
+            measures.push_back(measure(benchmark, counters, minTime));
+        }
+
+        std::sort(measures.begin(), measures.end(), [](const Result& a, const Result& b) { return a.ns < b.ns; });
+
+        auto result = measures[measures.size() / 2];
+        result.spread = (measures.back().ns - measures.front().ns) / result.ns;
+        return result;
+    }
+
+    /** \brief Returns the key of the baselines of this machine, the CPU model and the instruction set of the
+     * kernels. Timings of other machines aren't comparable.
+     *
+     */
+    std::string machineKey()
+    {
+        std::string model = "unknown CPU";
+#ifdef __linux__
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        std::string line;
+        while (std::getline(cpuinfo, line)) {
+            const auto colon = line.find(':');
+            if (line.compare(0, 10, "model name") == 0 && colon != std::string::npos) {
+                model = line.substr(line.find_first_not_of(" \t", colon + 1));
+                break;
+            }
+        }
+#endif
+
+        return model + ", " + Kernels::isaName(Kernels::detectIsa());
+    }
+
+    /** \brief Reads the baseline of the given machine from a baseline file. The file has a "[machine key]" line
+     * before the "name ns_per_op spread" lines of each machine. Returns false if the file can't be read.
+     * \param[in] filename baseline file name.
+     * \param[in] machine machine key.
+     * \param[out] baseline reference of each benchmark, empty if the machine has no baseline.
+     *
+     */
+    bool readBaseline(const std::string& filename, const std::string& machine,
+                      std::map<std::string, Reference>& baseline)
+    {
+        std::ifstream file(filename);
+        if (!file) {
+            return false;
+        }
+
+        bool section = false;
+        std::string line;
+        while (std::getline(file, line)) {
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+
+            if (line[0] == '[') {
+                section = (line == "[" + machine + "]");
+                continue;
+            }
+
+            std::istringstream stream(line);
+            std::string name;
+            Reference reference{0, 0};
+            if (section && stream >> name >> reference.ns) {
+                stream >> reference.spread;
+                baseline[name] = reference;
+            }
+        }
+
+        return true;
+    }
+
+    /** \brief Writes the results as the baseline of the given machine, keeping the baselines of the other machines
+     * of the file if it exists. Returns false on error.
+     * \param[in] filename baseline file name.
+     * \param[in] machine machine key.
+     * \param[in] results results to save.
+     *
+     */
+    bool saveBaseline(const std::string& filename, const std::string& machine, const std::vector<Result>& results)
+    {
+        std::vector<std::string> others;
+        {
+            // Lines outside of a machine section are from an old format, without machine, and are dropped.
+            std::ifstream file(filename);
+            bool other = false;
+            std::string line;
+            while (std::getline(file, line)) {
+                if (!line.empty() && line[0] == '[') {
+                    other = (line != "[" + machine + "]");
+                }
+                if (other && !line.empty() && line[0] != '#') {
+                    others.push_back(line);
+                }
+            }
+        }
+
+        std::ofstream file(filename);
+        file << "# www_microbench baselines: a [CPU model, instruction set] line per machine followed by the\n"
+             << "# benchmark name, the median ns per operation and the spread of the measures. The timings are only\n"
+             << "# compared on the same machine, run www_microbench --save on a new machine to add its baseline.\n";
+        for (const auto& line : others) {
+            file << line << "\n";
+        }
+
+        file << "[" << machine << "]\n";
+        for (const auto& result : results) {
+            file << result.name << " " << result.ns << " " << result.spread << "\n";
+        }
+
+        return static_cast<bool>(file);
+    }
+
+    /** \brief Returns the force fields of the kernel benchmarks with the given fields enabled. The parameters are
+     * close to the optimum values, the particles stay inside the screen for many calls.
+     * \param[in] fields enabled fields.
+     *
+     */
+    Kernels::Fields fieldsOf(const std::vector<int>& fields)
+    {
+        Kernels::Fields result;
+        const float var[Kernels::FIELDS] = {0.003f, 1.0001f, 0.0001f, 1.0001f, 0.0001f, 1.0001f, 1.0001f, 1.0001f,
+                                            0.0001f, 0.0001f, 0.0001f, 0.3f, 0.01f, 0.0001f, 0.3f, 0.01f};
+        std::copy(var, var + Kernels::FIELDS, result.var);
+        std::fill(result.enabled, result.enabled + Kernels::FIELDS, false);
+        for (const auto field : fields) {
+            result.enabled[field] = true;
+        }
+
+        // Same composition as WhirlWindWarp, only warp and rotation are relevant here.
+        const float warp = result.enabled[1] ? var[1] : 1.f;
+        const float c = result.enabled[2] ? std::cos(1.1 * var[2]) : 1.f;
+        const float s = result.enabled[2] ? std::sin(1.1 * var[2]) : 0.f;
+        const float affine[6] = {warp * c, warp * s, 0.f, -warp * s, warp * c, 0.f};
+        std::copy(affine, affine + 6, result.affine);
+
+        result.numPoints = PARTICLES;
+        Kernels::prepare(result);
+
+        return result;
+    }
+} // namespace
+
+//--------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!parse(argc, argv, options)) {
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    // Input data shared by the benchmarks.
+    Utils::FastNumberGenerator random(-0.9f, 0.9f, 1);
+    Utils::AlignedVector<float> x(PARTICLES), y(PARTICLES);
+    random.fill(x.data(), PARTICLES);
+    random.fill(y.data(), PARTICLES);
+
+    std::vector<Utils::hsv> hsvColors(PARTICLES);
+    std::vector<Utils::rgb> rgbColors(PARTICLES);
+    for (int i = 0; i < PARTICLES; ++i) {
+        hsvColors[i] = Utils::hsv((random.get() + 1.f) * 180.f, 0.6f + 0.4f * random.get(), 0.6f + 0.4f * random.get());
+        rgbColors[i] = Utils::hsv2rgb(hsvColors[i]);
+    }
+
+    State state{};
+    state.numPoints = PARTICLES;
+    const float identity[6] = {1.f, 0.f, 0.f, 0.f, 1.f, 0.f};
+    std::copy(identity, identity + 6, state.affine);
+    Utils::Configuration config;
+    Utils::NumberGenerator generator(-1.f, 1.f, 1);
+    Particles particles(state, &generator, config);
+
+    std::vector<std::uint32_t> indexes(PARTICLES);
+    std::iota(indexes.begin(), indexes.end(), 0);
+
+    std::vector<Benchmark> benchmarks;
+
+    // Force field stages of Particles::advance(), with the widest kernel and the scalar reference.
+    struct Stage
+    {
+        const char* name;
+        std::vector<int> fields;
+    };
+    const Stage stages[] = {{"squirge_x", {6}},      {"squirge_y", {7}},          {"affine", {1, 2}},
+                            {"split", {0, 8, 9}},    {"wave_y", {10, 11, 12}},    {"wave_x", {13, 14, 15}}};
+
+    for (const auto isa : {Kernels::detectIsa(), Kernels::Isa::SCALAR}) {
+        for (const auto& stage : stages) {
+            const auto fields = fieldsOf(stage.fields);
+            const auto kernel = Kernels::advanceFunction(isa, fields.mask);
+            const auto name = std::string("kernel.") + stage.name + "." + Kernels::isaName(isa);
+            benchmarks.push_back(Benchmark{name, PARTICLES, [&, fields, kernel]() {
+                                               kernel(fields, x.data(), y.data(), 0, PARTICLES);
+                                           }});
+        }
+    }
+
+    benchmarks.push_back(Benchmark{"particles.reset", PARTICLES, [&]() {
+                                       for (int i = 0; i < PARTICLES; ++i) {
+                                           particles.reset(i);
+                                       }
+                                   }});
+
+    benchmarks.push_back(Benchmark{"particles.respawn", PARTICLES,
+                                   [&]() { particles.respawn(indexes.data(), PARTICLES); }});
+
+    benchmarks.push_back(Benchmark{"utils.hsv2rgb", PARTICLES, [&]() {
+                                       for (int i = 0; i < PARTICLES; ++i) {
+                                           rgbColors[i] = Utils::hsv2rgb(hsvColors[i]);
+                                       }
+                                   }});
+
+    benchmarks.push_back(Benchmark{"utils.hsv2rgb_batch", PARTICLES, [&]() {
+                                       Utils::hsv2rgb(hsvColors.data(), rgbColors.data(), PARTICLES);
+                                   }});
+
+    benchmarks.push_back(Benchmark{"utils.rgb2hsv", PARTICLES, [&]() {
+                                       for (int i = 0; i < PARTICLES; ++i) {
+                                           hsvColors[i] = Utils::rgb2hsv(rgbColors[i]);
+                                       }
+                                   }});
+
+    benchmarks.push_back(Benchmark{"random.number_generator_get", PARTICLES, [&]() {
+                                       float sum = 0;
+                                       for (int i = 0; i < PARTICLES; ++i) {
+                                           sum += generator.get();
+                                       }
+                                       sink = sum;
+                                   }});
+
+    // Run.
+    Counters counters;
+    std::vector<Result> results;
+    for (const auto& benchmark : benchmarks) {
+        if (benchmark.name.find(options.filter) != std::string::npos) {
+            results.push_back(measureMedian(benchmark, counters, options.minTime, options.repeats));
+        }
+    }
+
+    const auto machine = machineKey();
+    std::map<std::string, Reference> baseline;
+    if (!options.baseline.empty() && !readBaseline(options.baseline, machine, baseline)) {
+        std::cerr << "Can't read baseline file: " << options.baseline << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Report, with the ratio over the baseline if there is one. A benchmark regresses if it's slower than the
+    // threshold plus the noise of both measures.
+    int regressions = 0;
+    std::cout << "{\n"
+              << "  \"benchmark\": \"www_microbench\",\n"
+              << "  \"machine\": \"" << machine << "\",\n"
+              << "  \"counters\": " << (counters.available() ? "\"perf_event\"" : "\"timer\"") << ",\n"
+              << "  \"repeats\": " << options.repeats << ",\n"
+              << "  \"threshold\": " << options.threshold << ",\n"
+              << "  \"baseline_machine\": " << (baseline.empty() ? "false" : "true") << ",\n"
+              << "  \"results\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const auto& result = results[i];
+        std::cout << "    {\"name\": \"" << result.name << "\", \"ns_per_op\": " << result.ns << ", \"spread\": "
+                  << result.spread;
+        if (counters.available()) {
+            for (int c = 0; c < COUNTERS; ++c) {
+                std::cout << ", \"" << COUNTER_NAMES[c] << "_per_op\": " << result.counters[c];
+            }
+        }
+
+        const auto reference = baseline.find(result.name);
+        if (reference != baseline.end()) {
+            const double ratio = result.ns / reference->second.ns;
+            const double allowed = 1.0 + options.threshold + result.spread + reference->second.spread;
+            const bool regression = ratio > allowed;
+            regressions += regression;
+            std::cout << ", \"baseline_ns_per_op\": " << reference->second.ns << ", \"ratio\": " << ratio
+                      << ", \"allowed_ratio\": " << allowed << ", \"regression\": " << (regression ? "true" : "false");
+        }
+
+        std::cout << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    std::cout << "  ],\n"
+              << "  \"regressions\": " << regressions << "\n"
+              << "}" << std::endl;
+
+    if (!options.save.empty() && !saveBaseline(options.save, machine, results)) {
+        std::cerr << "Can't write baseline file: " << options.save << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return regressions == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
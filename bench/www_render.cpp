@@ -0,0 +1,250 @@
+/*
+ File: www_render.cpp
+ Created on: 17/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <FrameWriter.h>
+#include <SoftwareRenderer.h>
+#include <Utils.h>
+#include <WhirlWindWarp.h>
+
+// C++
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+namespace
+{
+    /** \struct Options
+     * \brief Recording command line options.
+     *
+     */
+    struct Options
+    {
+        std::string output;          /** video file or image sequence name.              */
+        FrameWriter::Format format;  /** file format, from the output extension.         */
+        int points;                  /** number of particles.                            */
+        int frames;                  /** number of recorded frames.                      */
+        int warmup;                  /** number of frames advanced before recording.     */
+        std::uint64_t seed;          /** random number generator seed.                   */
+        int width;                   /** frame width in pixels.                          */
+        int height;                  /** frame height in pixels.                         */
+        int fps;                     /** frames per second of the video.                 */
+        int queue;                   /** maximum number of frames waiting to be written. */
+        unsigned int threads;        /** simulation and rendering threads, 0 for all.    */
+        Utils::Configuration config; /** trails, trail length and motion blur.           */
+
+        /** \brief Options struct constructor.
+         *
+         */
+        Options() :
+            output{},
+            format{FrameWriter::Format::Y4M},
+            points{100000},
+            frames{600},
+            warmup{0},
+            seed{1},
+            width{1920},
+            height{1080},
+            fps{60},
+            queue{4},
+            threads{0},
+            config{} {};
+    };
+
+    /** \brief Prints the usage to the standard error.
+     *
+     */
+    void usage()
+    {
+        std::cerr << "Usage: www_render --output FILE [--points N] [--frames N] [--warmup N] [--seed N]\n"
+                  << "                  [--size WIDTHxHEIGHT] [--fps N] [--trails on|off] [--trail-length N]\n"
+                  << "                  [--blur on|off] [--queue N] [--threads N]\n"
+                  << "  --output        video or images, the extension selects the format: .y4m, .raw (rgb24)\n"
+                  << "                  or .png (a numbered image per frame).\n"
+                  << "  --points        number of particles in [1000, 1000000], default 100000.\n"
+                  << "  --frames        number of recorded frames, default 600.\n"
+                  << "  --warmup        number of frames advanced before recording, default 0.\n"
+                  << "  --seed          random number generator seed, default 1.\n"
+                  << "  --size          frame size, default 1920x1080.\n"
+                  << "  --fps           frames per second of the video, default 60.\n"
+                  << "  --trails        particle trails on or off, default on.\n"
+                  << "  --trail-length  number of segments of the trails in [1, " << Utils::MAX_TRAIL_LENGTH
+                  << "], default 1.\n"
+                  << "  --blur          motion blur on or off, default off.\n"
+                  << "  --queue         maximum number of frames waiting to be written, default 4.\n"
+                  << "  --threads       simulation and rendering threads, default all the hardware threads.\n"
+                  << "Every frame advances the simulation one step, independent of the time taken to render it.\n"
+                  << "The results are written to the standard output in JSON." << std::endl;
+    }
+
+    /** \brief Parses the given on|off value, returns false if it's neither.
+     * \param[in] value command line value.
+     * \param[out] enabled true if on.
+     *
+     */
+    bool parseSwitch(const std::string& value, bool& enabled)
+    {
+        if (value != "on" && value != "off") {
+            return false;
+        }
+
+        enabled = (value == "on");
+        return true;
+    }
+
+    /** \brief Parses the command line into the given options, returns false on error.
+     * \param[in] argc number of arguments.
+     * \param[in] argv arguments.
+     * \param[out] options parsed options.
+     *
+     */
+    bool parse(int argc, char* argv[], Options& options)
+    {
+        options.config.show_trails = true;
+        options.config.trail_length = 1;
+        options.config.motion_blur = false;
+
+        for (int i = 1; i < argc; i += 2) {
+            const std::string name = argv[i];
+            if (i + 1 >= argc) {
+                return false;
+            }
+
+            const std::string value = argv[i + 1];
+            if (name == "--output") {
+                options.output = value;
+                if (!FrameWriter::formatOf(value, options.format)) {
+                    return false;
+                }
+            } else if (name == "--points") {
+                options.points = std::atoi(value.c_str());
+            } else if (name == "--frames") {
+                options.frames = std::atoi(value.c_str());
+            } else if (name == "--warmup") {
+                options.warmup = std::atoi(value.c_str());
+            } else if (name == "--seed") {
+                options.seed = std::strtoull(value.c_str(), nullptr, 10);
+            } else if (name == "--size") {
+                if (std::sscanf(value.c_str(), "%dx%d", &options.width, &options.height) != 2) {
+                    return false;
+                }
+            } else if (name == "--fps") {
+                options.fps = std::atoi(value.c_str());
+            } else if (name == "--trails") {
+                if (!parseSwitch(value, options.config.show_trails)) {
+                    return false;
+                }
+            } else if (name == "--trail-length") {
+                options.config.trail_length = static_cast<unsigned int>(std::max(std::atoi(value.c_str()), 0));
+            } else if (name == "--blur") {
+                if (!parseSwitch(value, options.config.motion_blur)) {
+                    return false;
+                }
+            } else if (name == "--queue") {
+                options.queue = std::atoi(value.c_str());
+            } else if (name == "--threads") {
+                options.threads = static_cast<unsigned int>(std::max(std::atoi(value.c_str()), 0));
+            } else {
+                return false;
+            }
+        }
+
+        const auto length = options.config.trail_length;
+        return !options.output.empty() && options.points >= 1000 && options.points <= 1000000 && options.frames > 0 &&
+               options.warmup >= 0 && options.width > 0 && options.height > 0 && options.fps > 0 &&
+               options.queue > 0 && length >= 1 && length <= static_cast<unsigned int>(Utils::MAX_TRAIL_LENGTH);
+    }
+} // namespace
+
+//--------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!parse(argc, argv, options)) {
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    WhirlWindWarp www(options.points, options.config, options.seed);
+    www.particles().setThreads(options.threads);
+    SoftwareRenderer renderer(options.width, options.height, options.config);
+    FrameWriter writer(options.output, options.format, options.width, options.height, options.fps, options.queue);
+    if (!writer.isOpen()) {
+        std::cerr << "Unable to create output file: " << options.output << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    for (int i = 0; i < options.warmup; ++i) {
+        www.advance();
+        renderer.render(www.particles());
+    }
+
+    // The writer converts and writes a frame while the next one is simulated and rendered, the time waiting for
+    // a free queue slot is the time the writer is behind.
+    const std::size_t size = static_cast<std::size_t>(options.width) * options.height * 4;
+    double blocked = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < options.frames; ++i) {
+        www.advance();
+        renderer.render(www.particles());
+
+        auto frame = writer.buffer();
+        std::memcpy(frame.data(), renderer.pixels(), size);
+
+        const auto push = std::chrono::steady_clock::now();
+        if (!writer.push(std::move(frame))) {
+            break;
+        }
+        blocked += std::chrono::duration<double>(std::chrono::steady_clock::now() - push).count();
+    }
+    writer.finish();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (writer.frames() != static_cast<unsigned long long>(options.frames)) {
+        std::cerr << "Error writing to: " << options.output << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const char* formats[] = {"y4m", "raw", "png"};
+    const double fps = options.frames / seconds;
+
+    std::cout << "{\n"
+              << "  \"benchmark\": \"www_render\",\n"
+              << "  \"output\": \"" << options.output << "\",\n"
+              << "  \"format\": \"" << formats[static_cast<int>(options.format)] << "\",\n"
+              << "  \"points\": " << options.points << ",\n"
+              << "  \"frames\": " << options.frames << ",\n"
+              << "  \"seed\": " << options.seed << ",\n"
+              << "  \"size\": \"" << options.width << "x" << options.height << "\",\n"
+              << "  \"trails\": " << (options.config.show_trails ? "true" : "false") << ",\n"
+              << "  \"trail_length\": " << options.config.trail_length << ",\n"
+              << "  \"blur\": " << (options.config.motion_blur ? "true" : "false") << ",\n"
+              << "  \"seconds\": " << seconds << ",\n"
+              << "  \"fps\": " << fps << ",\n"
+              << "  \"realtime_factor\": " << fps / options.fps << ",\n"
+              << "  \"writer_wait_ms_per_frame\": " << blocked * 1e3 / options.frames << "\n"
+              << "}" << std::endl;
+
+    return EXIT_SUCCESS;
+}
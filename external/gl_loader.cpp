@@ -78,7 +78,17 @@ const char *gl_function_names[] = {
 	"glGetProgramInfoLog",
 	"glBlendEquation",
 	"glBlendColor",
-	"glUniform1fv"
+	"glUniform1fv",
+	"glMapBufferRange",
+	"glUnmapBuffer",
+	"glFenceSync",
+	"glClientWaitSync",
+	"glDeleteSync",
+	"glBufferSubData",
+	"glVertexAttribDivisor",
+	"glDrawArraysInstanced",
+	"glTexBuffer",
+	"glUniform1i"
 };
 
 /** \brief Array of GL function pointers.
@@ -86,6 +96,18 @@ const char *gl_function_names[] = {
  */
 void *gl_function_pointers[sizeof(gl_function_names) / sizeof(const char *)];
 
+/** \brief Names of optional GL functions to load.
+ *
+ */
+const char *gl_optional_function_names[] = {
+	"glBufferStorage"
+};
+
+/** \brief Array of optional GL function pointers.
+ *
+ */
+void *gl_optional_function_pointers[sizeof(gl_optional_function_names) / sizeof(const char *)];
+
 #ifdef DEBUG
 /** \brief Names of GL debug functions to load.
  *
@@ -97,8 +119,7 @@ const char *gl_debug_function_names[] = {
 	"glEndQuery",
 	"glBeginQuery",
 	"glGetProgramiv",
-	"glMapBuffer",
-	"glUnmapBuffer"
+	"glMapBuffer"
 };
 
 /** \brief Array of GL debug function pointers.
@@ -123,6 +144,11 @@ int load_gl_functions()
 		}
 	}
 
+	for (unsigned long long i = 0; i < sizeof(gl_optional_function_names) / sizeof(const char *); i++)
+	{
+		gl_optional_function_pointers[i] = GetAnyGLFuncAddress(gl_optional_function_names[i]);
+	}
+
 #ifdef DEBUG
 	for (unsigned long long  i = 0; i < sizeof(gl_debug_function_names) / sizeof(const char *); i++)
 	{
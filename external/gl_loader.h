@@ -26,7 +26,13 @@
  */
 extern void* gl_function_pointers[]; 
 
-/** \brief Loads the GL functions and returns the number of functions that failed to load. 
+/** \brief Optional OpenGL function pointers, newer than the 4.0 context, or nullptr if not supported.
+ *
+ */
+extern void* gl_optional_function_pointers[];
+
+/** \brief Loads the GL functions and returns the number of functions that failed to load. Optional functions
+ * that fail to load are not counted.
  *
  */ 
 int load_gl_functions(); 
@@ -65,6 +71,19 @@ int load_gl_functions();
 #define glBlendEquation ((PFNGLBLENDEQUATIONPROC)gl_function_pointers[30])
 #define glBlendColor ((PFNGLBLENDCOLORPROC)gl_function_pointers[31])
 #define glUniform1fv ((PFNGLUNIFORM1FVPROC)gl_function_pointers[32])
+#define glMapBufferRange ((PFNGLMAPBUFFERRANGEPROC)gl_function_pointers[33])
+#define glUnmapBuffer ((PFNGLUNMAPBUFFERPROC)gl_function_pointers[34])
+#define glFenceSync ((PFNGLFENCESYNCPROC)gl_function_pointers[35])
+#define glClientWaitSync ((PFNGLCLIENTWAITSYNCPROC)gl_function_pointers[36])
+#define glDeleteSync ((PFNGLDELETESYNCPROC)gl_function_pointers[37])
+#define glBufferSubData ((PFNGLBUFFERSUBDATAPROC)gl_function_pointers[38])
+#define glVertexAttribDivisor ((PFNGLVERTEXATTRIBDIVISORPROC)gl_function_pointers[39])
+#define glDrawArraysInstanced ((PFNGLDRAWARRAYSINSTANCEDPROC)gl_function_pointers[40])
+#define glTexBuffer ((PFNGLTEXBUFFERPROC)gl_function_pointers[41])
+#define glUniform1i ((PFNGLUNIFORM1IPROC)gl_function_pointers[42])
+
+// GL optional function definitions, check for nullptr before use.
+#define glBufferStorage ((PFNGLBUFFERSTORAGEPROC)gl_optional_function_pointers[0])
 
 // GL debug function definitions.
 #ifdef DEBUG
@@ -77,5 +96,4 @@ extern void* gl_debug_function_pointers[];
 #define glBeginQuery ((PFNGLBEGINQUERYPROC)gl_debug_function_pointers[4]) 
 #define glGetProgramiv ((PFNGLGETPROGRAMIVPROC)gl_debug_function_pointers[5]) 
 #define glMapBuffer ((PFNGLMAPBUFFERPROC)gl_debug_function_pointers[6]) 
-#define glUnmapBuffer ((PFNGLUNMAPBUFFERPROC)gl_debug_function_pointers[7]) 
 #endif
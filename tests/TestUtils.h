@@ -0,0 +1,60 @@
+/*
+ File: TestUtils.h
+ Created on: 17/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TESTUTILS_H_
+#define TESTUTILS_H_
+
+// C++
+#include <iostream>
+#include <sstream>
+#include <string>
+
+/** \brief Helpers shared by the unit tests.
+ *
+ */
+namespace TestUtils
+{
+    /** \brief Prints the result of a check, "PASS name: details" or "FAIL name: details", and returns it.
+     * \param[in] name check name.
+     * \param[in] passed true if the check passed.
+     * \param[in] details measured values, empty if none.
+     *
+     */
+    inline bool report(const std::string& name, const bool passed, const std::string& details = std::string())
+    {
+        std::cout << (passed ? "PASS " : "FAIL ") << name << (details.empty() ? "" : ": ") << details << std::endl;
+        return passed;
+    }
+
+    /** \brief Prints the result of the check of a measured value against its limit and returns it.
+     * \param[in] name check name.
+     * \param[in] passed true if the check passed.
+     * \param[in] value measured value.
+     * \param[in] limit limit of the measured value.
+     *
+     */
+    inline bool report(const std::string& name, const bool passed, const double value, const double limit)
+    {
+        std::ostringstream details;
+        details << value << " (limit " << limit << ")";
+        return report(name, passed, details.str());
+    }
+} // namespace TestUtils
+
+#endif // TESTUTILS_H_
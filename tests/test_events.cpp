@@ -0,0 +1,165 @@
+/*
+ File: test_events.cpp
+ Created on: 17/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <Particle.h>
+#include <Utils.h>
+#include <tests/TestUtils.h>
+
+// C++
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace
+{
+    const int CHUNK = 8192;                    /** particles of a chunk, the range of each sampling. */
+    const int CHUNKS = 122;                    /** chunks of a million particles.                    */
+    const int FRAMES = 200;                    /** sampled frames.                                   */
+    const double RESPAWN_PROBABILITY = 0.0025; /** probability of the random respawn of a particle.  */
+    const double COLOR_PROBABILITY = 0.125;    /** probability of the color change of a particle.    */
+    const std::uint32_t RESPAWN_SLOT = 10;     /** first random slot of the respawn gaps.            */
+    const std::uint32_t COLOR_SLOT = 0;        /** random slot of the color gap.                     */
+    const double Z = 3.719;                    /** normal quantile of the significance level, 1e-4.  */
+
+    /** \brief Returns the chi-square statistic of the observed counts given the expected ones.
+     * \param[in] observed observed counts.
+     * \param[in] expected expected counts.
+     *
+     */
+    double chiSquare(const std::vector<double>& observed, const std::vector<double>& expected)
+    {
+        double sum = 0;
+        for (std::size_t i = 0; i < observed.size(); ++i) {
+            sum += (observed[i] - expected[i]) * (observed[i] - expected[i]) / expected[i];
+        }
+        return sum;
+    }
+
+    /** \brief Returns the critical value of the chi-square distribution at the significance level, Wilson-Hilferty
+     * approximation.
+     * \param[in] dof degrees of freedom.
+     *
+     */
+    double chiSquareLimit(const int dof)
+    {
+        const double a = 2.0 / (9.0 * dof);
+        return dof * std::pow(1.0 - a + Z * std::sqrt(a), 3);
+    }
+
+} // namespace
+
+//--------------------------------------------------------------------
+int main()
+{
+    const Utils::CounterNumberGenerator random(-1.f, 1.f, 42);
+    bool passed = true;
+
+    // Respawn events of every chunk of every frame. The count of a chunk is binomial, the positions are uniform
+    // in the chunk.
+    std::vector<double> counts;
+    std::vector<double> positions(64, 0);
+    std::vector<std::uint32_t> events(CHUNK);
+    for (int frame = 0; frame < FRAMES; ++frame) {
+        for (int chunk = 0; chunk < CHUNKS; ++chunk) {
+            const int begin = chunk * CHUNK;
+            const int n = Particles::sampleEvents(random, frame, begin, begin + CHUNK, RESPAWN_SLOT,
+                                                  RESPAWN_PROBABILITY, events.data(), CHUNK);
+            counts.push_back(n);
+            for (int i = 0; i < n; ++i) {
+                positions[(events[i] - begin) * positions.size() / CHUNK] += 1;
+            }
+        }
+    }
+
+    {
+        const double samples = counts.size();
+        double mean = 0;
+        for (const auto count : counts) {
+            mean += count;
+        }
+        mean /= samples;
+
+        double variance = 0;
+        for (const auto count : counts) {
+            variance += (count - mean) * (count - mean);
+        }
+        variance /= samples - 1;
+
+        // Standard errors of the mean and of the variance, the count is close to normal.
+        const double expectedMean = CHUNK * RESPAWN_PROBABILITY;
+        const double expectedVariance = expectedMean * (1.0 - RESPAWN_PROBABILITY);
+        const double meanLimit = Z * std::sqrt(expectedVariance / samples);
+        const double varianceLimit = Z * expectedVariance * std::sqrt(2.0 / (samples - 1));
+
+        passed &= TestUtils::report("respawn count mean " + std::to_string(expectedMean),
+                                    std::abs(mean - expectedMean) < meanLimit, mean - expectedMean, meanLimit);
+        passed &= TestUtils::report("respawn count variance " + std::to_string(expectedVariance),
+                                    std::abs(variance - expectedVariance) < varianceLimit,
+                                    variance - expectedVariance, varianceLimit);
+
+        double total = 0;
+        for (const auto count : positions) {
+            total += count;
+        }
+        const std::vector<double> expected(positions.size(), total / positions.size());
+        const int dof = positions.size() - 1;
+        const double statistic = chiSquare(positions, expected);
+        passed &= TestUtils::report("respawn positions chi-square", statistic < chiSquareLimit(dof), statistic,
+                                    chiSquareLimit(dof));
+    }
+
+    // Color change events, the first particle of the chunk that changes is a geometric gap from its beginning.
+    // The last bin counts the gaps that don't fit in the others.
+    {
+        const int bins = 48;
+        std::vector<double> gaps(bins + 1, 0);
+        int samples = 0;
+        for (int frame = 0; frame < FRAMES * 4; ++frame) {
+            for (int chunk = 0; chunk < CHUNKS; ++chunk) {
+                const int begin = chunk * CHUNK;
+                std::uint32_t event;
+                ++samples;
+                if (Particles::sampleEvents(random, frame, begin, begin + CHUNK, COLOR_SLOT, COLOR_PROBABILITY, &event,
+                                            1)) {
+                    gaps[std::min<std::uint32_t>(event - begin, bins)] += 1;
+                } else {
+                    gaps[bins] += 1;
+                }
+            }
+        }
+
+        std::vector<double> expected(bins + 1);
+        double remaining = samples;
+        for (int i = 0; i < bins; ++i) {
+            expected[i] = remaining * COLOR_PROBABILITY;
+            remaining -= expected[i];
+        }
+        expected[bins] = remaining;
+
+        const double statistic = chiSquare(gaps, expected);
+        passed &= TestUtils::report("color gaps geometric chi-square", statistic < chiSquareLimit(bins), statistic,
+                                    chiSquareLimit(bins));
+    }
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,193 @@
+/*
+ File: test_fastmath.cpp
+ Created on: 17/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <FastMath.h>
+#include <tests/TestUtils.h>
+
+// C++
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    const int LANES = 4;                                                  /** lanes of the tested vectors. */
+    typedef float f4 __attribute__((vector_size(LANES * sizeof(float)))); /** vector of floats.            */
+
+    /** \brief Applies the given approximation to the values, a vector at a time.
+     * \param[in] values input values, a multiple of LANES.
+     * \param[in] function vector approximation.
+     *
+     */
+    template <typename Function>
+    std::vector<float> approximate(const std::vector<float>& values, const Function& function)
+    {
+        std::vector<float> results(values.size());
+        for (std::size_t i = 0; i < values.size(); i += LANES) {
+            f4 x;
+            std::memcpy(&x, &values[i], sizeof(x));
+            const f4 y = function(x);
+            std::memcpy(&results[i], &y, sizeof(y));
+        }
+
+        return results;
+    }
+
+    /** \brief Checks the error of an approximation against the double precision reference. Returns false and
+     * prints the worst value if the error of any value is over its bound.
+     * \param[in] name approximation name.
+     * \param[in] values input values.
+     * \param[in] results approximated values.
+     * \param[in] reference double precision function.
+     * \param[in] error error of an approximated value given the exact one.
+     * \param[in] bound error bound of an input value.
+     *
+     */
+    bool check(const std::string& name, const std::vector<float>& values, const std::vector<float>& results,
+               const std::function<double(double)>& reference, const std::function<double(double, double)>& error,
+               const std::function<double(double)>& bound)
+    {
+        double worst = 0;
+        double worstValue = 0;
+        bool passed = true;
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            const double exact = reference(values[i]);
+            const double e = error(results[i], exact);
+            const double ratio = e / bound(values[i]);
+            if (!(ratio <= 1.0)) {
+                passed = false;
+            }
+            if (!(ratio <= worst)) {
+                worst = ratio;
+                worstValue = values[i];
+            }
+        }
+
+        std::ostringstream details;
+        details << values.size() << " values, worst error " << worst << " of the bound at " << worstValue;
+        return TestUtils::report(name, passed, details.str());
+    }
+
+    /** \brief Returns the absolute error.
+     *
+     */
+    double absolute(const double value, const double exact)
+    {
+        return std::abs(value - exact);
+    }
+
+    /** \brief Returns the relative error.
+     *
+     */
+    double relative(const double value, const double exact)
+    {
+        return std::abs(value - exact) / std::abs(exact);
+    }
+
+    /** \brief Returns count uniform values in [min, max], rounded up to a multiple of LANES.
+     *
+     */
+    std::vector<float> uniform(std::mt19937& generator, const std::size_t count, const float min, const float max)
+    {
+        std::uniform_real_distribution<float> distribution(min, max);
+        std::vector<float> values((count + LANES - 1) / LANES * LANES);
+        std::generate(values.begin(), values.end(), [&]() { return distribution(generator); });
+        return values;
+    }
+} // namespace
+
+//--------------------------------------------------------------------
+int main()
+{
+    std::mt19937 generator(1);
+    bool passed = true;
+
+    // log2: every 64th mantissa of [1, 2) and random values of every normal exponent.
+    {
+        std::vector<float> values;
+        for (std::uint32_t mantissa = 0; mantissa < (1u << 23); mantissa += 64) {
+            const std::uint32_t bits = 0x3F800000u | mantissa;
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            values.push_back(value);
+        }
+        std::uniform_int_distribution<std::uint32_t> normals(0x00800000u, 0x7F7FFFFFu);
+        for (int i = 0; i < (1 << 20); ++i) {
+            const std::uint32_t bits = normals(generator);
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            values.push_back(value);
+        }
+
+        const auto results = approximate(values, [](const f4& x) { return FastMath::log2(x); });
+        const auto bound = [](const double x) { return 1.5e-7 * std::max(1.0, std::abs(std::log2(x))); };
+        passed &= check("log2", values, results, [](const double x) { return std::log2(x); }, absolute, bound);
+    }
+
+    // exp2 in the whole clamped range.
+    {
+        auto values = uniform(generator, 1 << 20, -126.f, 127.f);
+        values.insert(values.end(), {-126.f, -125.5f, -0.5f, 0.f, 0.5f, 1.f, 126.5f, 127.f});
+
+        const auto results = approximate(values, [](const f4& x) { return FastMath::exp2(x); });
+        const auto bound = [](const double) { return 2.5e-7; };
+        passed &= check("exp2", values, results, [](const double x) { return std::exp2(x); }, relative, bound);
+    }
+
+    // pow with the bases and exponents of the squirge fields, bases log-uniform in [1e-6, 1].
+    for (const float exponent : {0.25f, 0.5f, 0.9f, 1.f, 1.1f, 2.f, 3.3f, 4.f}) {
+        auto values = uniform(generator, 1 << 18, std::log(1e-6f), 0.f);
+        std::transform(values.begin(), values.end(), values.begin(), [](const float x) { return std::exp(x); });
+        values.insert(values.end(), {1e-6f, 1e-3f, 0.1f, 0.5f, 0.75f, 0.999f, 1.f, 1.f});
+
+        const auto results = approximate(values, [exponent](const f4& x) { return FastMath::pow(x, exponent); });
+        const auto reference = [exponent](const double x) { return std::pow(x, static_cast<double>(exponent)); };
+        const auto bound = [](const double) { return 6e-6; };
+        passed &= check("pow ^" + std::to_string(exponent), values, results, reference, relative, bound);
+    }
+
+    // pow of bases lesser or equal to zero.
+    {
+        const std::vector<float> values = {0.f, -0.f, -1e-6f, -0.5f, -1.f, -2.f, -100.f, -1e30f};
+        const auto results = approximate(values, [](const f4& x) { return FastMath::pow(x, 2.f); });
+        const bool zeros = std::all_of(results.cbegin(), results.cend(), [](const float x) { return x == 0.f; });
+        passed &= TestUtils::report("pow of non positive bases is zero", zeros);
+    }
+
+    // sin for |x| < 100.
+    {
+        auto values = uniform(generator, 1 << 21, -100.f, 100.f);
+        values.insert(values.end(), {0.f, FastMath::PI / 2, FastMath::PI, -FastMath::PI, 2 * FastMath::PI, 99.99f,
+                                     -99.99f, 1e-30f});
+
+        const auto results = approximate(values, [](const f4& x) { return FastMath::sin(x); });
+        const auto bound = [](const double) { return 2.5e-7; };
+        passed &= check("sin", values, results, [](const double x) { return std::sin(x); }, absolute, bound);
+    }
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
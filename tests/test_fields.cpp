@@ -0,0 +1,142 @@
+/*
+ File: test_fields.cpp
+ Created on: 17/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <Kernels.h>
+#include <WhirlWindWarp.h>
+#include <tests/TestUtils.h>
+
+// C++
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+    const int FIELD_SETS = 500;         /** random field sets per test.                                */
+    const int POINTS = 1003;            /** particles advanced, not a multiple of the vector widths.   */
+    const double AFFINE_BOUND = 3e-7;   /** maximum difference with only the affine fields (1 to 5).   */
+    const double FIELDS_BOUND = 4.5e-7; /** maximum difference with every field, adds pow() and sin(). */
+    const int AFFINE_FIELDS = 0x3E;     /** bits of the affine fields.                                 */
+
+    /** \brief Returns a state with random enabled fields near their optimum values and the composed affine matrix.
+     * \param[in] generator random number generator.
+     * \param[in] fields bits of the fields that can be enabled.
+     * \param[in] set index of the field set.
+     *
+     */
+    State randomState(std::mt19937& generator, const int fields, const int set)
+    {
+        std::uniform_real_distribution<float> u(-1.f, 1.f);
+
+        State state;
+        for (int i = 0; i < fs; ++i) {
+            state.enabled[i] = ((fields >> i) & 1) && u(generator) > 0;
+            state.var[i] = 0;
+        }
+
+        state.var[0] = (set % 3 == 0 ? 0.3f : 0.01f) * u(generator);
+        state.var[1] = 1 + 0.01f * u(generator);
+        state.var[2] = 0.01f * u(generator);
+        state.var[3] = 1 + 0.01f * u(generator);
+        state.var[4] = 0.01f * u(generator);
+        state.var[5] = 1 + 0.01f * u(generator);
+        state.var[6] = 1 + 0.01f * u(generator);
+        state.var[7] = 1 + 0.01f * u(generator);
+        state.var[8] = 0.01f * u(generator);
+        state.var[9] = 0.01f * u(generator);
+        state.var[10] = 0.01f * u(generator);
+        state.var[11] = u(generator);
+        state.var[12] = 0.01f;
+        state.var[13] = 0.01f * u(generator);
+        state.var[14] = u(generator);
+        state.var[15] = 0.01f;
+        state.numPoints = POINTS;
+
+        WhirlWindWarp::composeAffineFields(state);
+        return state;
+    }
+
+    /** \brief Returns the maximum difference between the vector kernels of the CPU and the scalar reference, that
+     * applies the fields one after another in double precision, over random field sets.
+     * \param[in] fields bits of the fields that can be enabled.
+     *
+     */
+    double maxDifference(const int fields)
+    {
+        std::mt19937 generator(1);
+        std::uniform_real_distribution<float> u(-0.99f, 0.99f);
+
+        double difference = 0;
+        for (int set = 0; set < FIELD_SETS; ++set) {
+            const State state = randomState(generator, fields, set);
+
+            Kernels::Fields kernelFields;
+            std::copy(state.enabled, state.enabled + fs, kernelFields.enabled);
+            std::copy(state.var, state.var + fs, kernelFields.var);
+            std::copy(state.affine, state.affine + 6, kernelFields.affine);
+            kernelFields.numPoints = POINTS;
+            Kernels::prepare(kernelFields);
+
+            std::vector<float> x(POINTS), y(POINTS);
+            std::generate(x.begin(), x.end(), [&]() { return u(generator); });
+            std::generate(y.begin(), y.end(), [&]() { return u(generator); });
+
+            auto rx = x;
+            auto ry = y;
+            Kernels::advanceFunction(Kernels::Isa::SCALAR, kernelFields.mask)(kernelFields, rx.data(), ry.data(), 0,
+                                                                             POINTS);
+
+            // Two calls split at a different index every set, the kernels must handle unaligned ranges.
+            const int split = 1 + set % 700;
+            for (int isa = 1; isa <= static_cast<int>(Kernels::detectIsa()); ++isa) {
+                const auto kernel = Kernels::advanceFunction(static_cast<Kernels::Isa>(isa), kernelFields.mask);
+                auto vx = x;
+                auto vy = y;
+                kernel(kernelFields, vx.data(), vy.data(), 0, split);
+                kernel(kernelFields, vx.data(), vy.data(), split, POINTS);
+
+                for (int i = 0; i < POINTS; ++i) {
+                    difference = std::max(difference, static_cast<double>(std::abs(vx[i] - rx[i])));
+                    difference = std::max(difference, static_cast<double>(std::abs(vy[i] - ry[i])));
+                }
+            }
+        }
+
+        return difference;
+    }
+} // namespace
+
+//--------------------------------------------------------------------
+int main()
+{
+    std::cout << "Vector kernels up to " << Kernels::isaName(Kernels::detectIsa()) << std::endl;
+
+    bool passed = true;
+    const double affine = maxDifference(AFFINE_FIELDS);
+    const double fields = maxDifference((1 << fs) - 1);
+    passed &= TestUtils::report("composed affine fields maximum difference", affine <= AFFINE_BOUND, affine,
+                                AFFINE_BOUND);
+    passed &= TestUtils::report("all the fields maximum difference", fields <= FIELDS_BOUND, fields, FIELDS_BOUND);
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,131 @@
+/*
+ File: test_random.cpp
+ Created on: 17/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <Utils.h>
+#include <tests/TestUtils.h>
+
+// C++
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    /** \struct KnownAnswer
+     * \brief Philox4x32-10 known-answer vector of the Random123 distribution.
+     *
+     */
+    struct KnownAnswer
+    {
+        std::uint64_t key;         /** key, the seed of the generator. */
+        std::uint32_t counter[4];  /** counter.                        */
+        std::uint32_t expected[4]; /** random words.                   */
+    };
+
+    const KnownAnswer KNOWN_ANSWERS[] = {
+        {0x0000000000000000ull, {0x00000000, 0x00000000, 0x00000000, 0x00000000},
+         {0x6627E8D5, 0xE169C58D, 0xBC57AC4C, 0x9B00DBD8}},
+        {0xFFFFFFFFFFFFFFFFull, {0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF},
+         {0x408F276D, 0x41C83B0E, 0xA20BC7C6, 0x6D5451FD}},
+        {0x299F31D0A4093822ull, {0x243F6A88, 0x85A308D3, 0x13198A2E, 0x03707344},
+         {0xD16CFE09, 0x94FDCCEB, 0x5001E420, 0x24126EA1}}};
+
+    const std::uint64_t SEED = 0x0123456789ABCDEFull; /** seed of the stream checks.                       */
+    const std::uint64_t FRAME = 0x100000007ull;       /** frame of the stream checks, both words used.     */
+    const std::uint32_t SLOT = 5;                     /** slot of the stream checks.                       */
+    const std::uint32_t FIRST = 4099;                 /** first stream of the run, not a multiple of four. */
+    const std::size_t STREAMS = 10001;                /** streams of the run.                              */
+
+    /** \brief Returns true if both buffers have the same bits.
+     *
+     */
+    bool equal(const std::vector<float>& a, const std::vector<float>& b)
+    {
+        return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+    }
+} // namespace
+
+//--------------------------------------------------------------------
+int main()
+{
+    bool passed = true;
+
+    // Philox4x32-10 rounds.
+    for (const auto& answer : KNOWN_ANSWERS) {
+        const Utils::CounterNumberGenerator generator(0.f, 1.f, answer.key);
+        std::uint32_t words[4];
+        std::copy(answer.counter, answer.counter + 4, words);
+        generator.philox(words);
+
+        std::ostringstream name;
+        name << "Philox4x32-10 known answer of key " << std::hex << answer.key << " and counter " << answer.counter[0];
+        passed &= TestUtils::report(name.str(), std::equal(words, words + 4, answer.expected));
+    }
+
+    // Four consecutive streams share a block, the stream takes the word of its index modulo four. With the limits
+    // [0, 2^24) the numbers are the upper 24 bits of the words.
+    {
+        const Utils::CounterNumberGenerator generator(0.f, 16777216.f, SEED);
+        bool layout = true;
+        for (std::uint32_t block = 0; block < 1000; ++block) {
+            std::uint32_t words[4] = {block, static_cast<std::uint32_t>(FRAME), static_cast<std::uint32_t>(FRAME >> 32),
+                                      SLOT};
+            generator.philox(words);
+            for (std::uint32_t lane = 0; lane < 4; ++lane) {
+                layout &= generator.get(FRAME, 4 * block + lane, SLOT) == static_cast<float>(words[lane] >> 8);
+            }
+        }
+        passed &= TestUtils::report("streams take the word of their index in the block of four", layout);
+    }
+
+    // fill() over a run and gather() over the shuffled indexes return the numbers of get().
+    {
+        const Utils::CounterNumberGenerator generator(-1.f, 1.f, SEED);
+        std::vector<float> expected(STREAMS);
+        for (std::size_t i = 0; i < STREAMS; ++i) {
+            expected[i] = generator.get(FRAME, FIRST + static_cast<std::uint32_t>(i), SLOT);
+        }
+
+        std::vector<float> filled(STREAMS);
+        generator.fill(FRAME, FIRST, SLOT, filled.data(), STREAMS);
+        passed &= TestUtils::report("fill() equals get() over a run", equal(filled, expected));
+
+        std::vector<std::uint32_t> indexes(STREAMS);
+        std::iota(indexes.begin(), indexes.end(), FIRST);
+        std::shuffle(indexes.begin(), indexes.end(), std::mt19937(1));
+
+        std::vector<float> gathered(STREAMS);
+        generator.gather(FRAME, indexes.data(), SLOT, gathered.data(), STREAMS);
+
+        std::vector<float> shuffled(STREAMS);
+        for (std::size_t i = 0; i < STREAMS; ++i) {
+            shuffled[i] = expected[indexes[i] - FIRST];
+        }
+        passed &= TestUtils::report("gather() of shuffled indexes equals get()", equal(gathered, shuffled));
+    }
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
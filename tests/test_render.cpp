@@ -0,0 +1,125 @@
+/*
+ File: test_render.cpp
+ Created on: 17/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <Kernels.h>
+#include <SoftwareRenderer.h>
+#include <WhirlWindWarp.h>
+#include <tests/TestUtils.h>
+
+// C++
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+namespace
+{
+    const int POINTS = 20000;                           /** simulated particles.                             */
+    const int WIDTH = 320;                              /** framebuffer width.                               */
+    const int HEIGHT = 200;                             /** framebuffer height.                              */
+    const int FRAMES = 60;                              /** rendered frames.                                 */
+    const std::uint64_t SEED = 7;                       /** simulation seed.                                 */
+    const std::uint64_t GOLDEN = 0x89B5A7152985BE29ull; /** hash of the frames, update on purposeful changes. */
+
+    /** \brief Returns the 64 bit FNV-1a hash of the given bytes, chained from the given hash.
+     * \param[in] hash previous hash.
+     * \param[in] bytes bytes to hash.
+     * \param[in] size number of bytes.
+     *
+     */
+    std::uint64_t fnv1a(std::uint64_t hash, const std::uint8_t* bytes, const std::size_t size)
+    {
+        for (std::size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+        }
+        return hash;
+    }
+
+    /** \brief Renders the frames with points, trails of four segments and motion blur and returns the hash of the
+     * pixels of every frame. The particles use the scalar reference kernel so the pixels don't depend on the CPU.
+     * \param[in] threads number of threads of the particles and the renderer.
+     * \param[in] isa instruction set of the rasterizer.
+     * \param[out] drawn number of pixels of the last frame that aren't black.
+     *
+     */
+    std::uint64_t render(const unsigned int threads, const Kernels::Isa isa, int& drawn)
+    {
+        Utils::Configuration config;
+        config.show_trails = true;
+        config.trail_length = 4;
+        config.motion_blur = true;
+
+        WhirlWindWarp www(POINTS, config, SEED);
+        www.particles().setIsa(Kernels::Isa::SCALAR);
+        www.particles().setThreads(threads);
+
+        SoftwareRenderer renderer(WIDTH, HEIGHT, config);
+        renderer.setIsa(isa);
+
+        std::uint64_t hash = 0xCBF29CE484222325ull;
+        for (int frame = 0; frame < FRAMES; ++frame) {
+            www.advance();
+            renderer.render(www.particles());
+            hash = fnv1a(hash, renderer.pixels(), static_cast<std::size_t>(WIDTH) * HEIGHT * 4);
+        }
+
+        drawn = 0;
+        for (int i = 0; i < WIDTH * HEIGHT; ++i) {
+            const auto pixel = renderer.pixels() + 4 * i;
+            drawn += (pixel[0] | pixel[1] | pixel[2]) != 0;
+        }
+
+        return hash;
+    }
+
+    /** \brief Returns the hash in hexadecimal.
+     * \param[in] hash hash value.
+     *
+     */
+    std::string hex(const std::uint64_t hash)
+    {
+        std::ostringstream stream;
+        stream << "0x" << std::hex << std::uppercase << std::setw(16) << std::setfill('0') << hash;
+        return stream.str();
+    }
+} // namespace
+
+//--------------------------------------------------------------------
+int main()
+{
+    bool passed = true;
+
+    const auto widest = static_cast<int>(Kernels::detectIsa());
+    for (const unsigned int threads : {1u, 3u}) {
+        for (int i = 0; i <= widest; ++i) {
+            const auto isa = static_cast<Kernels::Isa>(i);
+            int drawn;
+            const auto hash = render(threads, isa, drawn);
+            const std::string name = std::string("frames with ") + std::to_string(threads) + " threads and the " +
+                                     Kernels::isaName(isa) + " rasterizer";
+            passed &= TestUtils::report(name + " aren't empty", drawn > WIDTH * HEIGHT / 100,
+                                        std::to_string(drawn) + " pixels drawn");
+            passed &= TestUtils::report(name, hash == GOLDEN, hex(hash) + " (golden " + hex(GOLDEN) + ")");
+        }
+    }
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
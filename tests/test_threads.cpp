@@ -0,0 +1,130 @@
+/*
+ File: test_threads.cpp
+ Created on: 17/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <WhirlWindWarp.h>
+#include <tests/TestUtils.h>
+
+// C++
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+    const int POINTS = 100000;      /** simulated particles, several chunks per thread. */
+    const int FRAMES = 300;         /** advanced frames.                                */
+    const std::uint64_t SEED = 3;   /** simulation seed.                                */
+    const unsigned int THREADS = 4; /** threads of the parallel runs.                   */
+
+    /** \struct Run
+     * \brief Simulation advanced with a number of threads and a respawn path.
+     *
+     */
+    struct Run
+    {
+        std::string name;                      /** run description.                             */
+        std::unique_ptr<WhirlWindWarp> www;    /** simulation.                                  */
+        std::vector<float> positions;          /** positions of the current frame.              */
+        std::vector<float> attributes;         /** attributes of the current frame.             */
+        std::vector<Particles::Range> changed; /** changed ranges of the current frame.         */
+        int firstDifference;                   /** first frame that differs from the reference. */
+    };
+
+    /** \brief Returns true if both lists of ranges are equal.
+     *
+     */
+    bool equal(const std::vector<Particles::Range>& a, const std::vector<Particles::Range>& b)
+    {
+        if (a.size() != b.size()) {
+            return false;
+        }
+
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            if (a[i].first != b[i].first || a[i].count != b[i].count) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /** \brief Returns true if both buffers have the same bits.
+     *
+     */
+    bool equal(const std::vector<float>& a, const std::vector<float>& b)
+    {
+        return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+    }
+} // namespace
+
+//--------------------------------------------------------------------
+int main()
+{
+    const Utils::Configuration config;
+
+    // The reference advances with one thread and the bulk respawn.
+    std::vector<Run> runs;
+    for (const bool inlineRespawn : {false, true}) {
+        for (const unsigned int threads : {1u, THREADS}) {
+            Run run;
+            run.name = std::to_string(threads) + (threads == 1 ? " thread, " : " threads, ") +
+                       (inlineRespawn ? "inline" : "bulk") + " respawn";
+            run.www = std::make_unique<WhirlWindWarp>(POINTS, config, SEED);
+            run.www->particles().setThreads(threads);
+            run.www->particles().setInlineRespawn(inlineRespawn);
+            run.firstDifference = -1;
+            runs.push_back(std::move(run));
+        }
+    }
+
+    for (int frame = 0; frame < FRAMES; ++frame) {
+        for (auto& run : runs) {
+            auto& particles = run.www->particles();
+            run.www->advance();
+            run.positions.resize(particles.positionsSize());
+            particles.fillPositions(run.positions.data());
+            run.attributes.resize(particles.attributesSize());
+            particles.fillAttributes(run.attributes.data(),
+                                     Particles::Range{0, static_cast<std::uint32_t>(particles.positionsSize() / 2)});
+            run.changed = particles.takeChangedRanges();
+
+            const auto& reference = runs.front();
+            const bool same = equal(run.positions, reference.positions) &&
+                              equal(run.attributes, reference.attributes) && equal(run.changed, reference.changed);
+            if (!same && run.firstDifference < 0) {
+                run.firstDifference = frame;
+            }
+        }
+    }
+
+    bool passed = true;
+    for (std::size_t i = 1; i < runs.size(); ++i) {
+        const auto& run = runs[i];
+        const std::string details = run.firstDifference < 0 ? std::to_string(FRAMES) + " frames with the same bits"
+                                                            : "differs at frame " +
+                                                                  std::to_string(run.firstDifference);
+        passed &= TestUtils::report(run.name + " equals " + runs.front().name, run.firstDifference < 0, details);
+    }
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,215 @@
+/*
+ File: test_trace.cpp
+ Created on: 17/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <WhirlWindWarp.h>
+#include <tests/TestUtils.h>
+
+// C++
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace
+{
+    const int POINTS = 20000;                     /** simulated particles.                      */
+    const int FRAMES = 200;                       /** recorded frames.                          */
+    const std::uint64_t SEED = 11;                /** seed of the recorded simulation.          */
+    const std::uint64_t OTHER_SEED = 12;          /** seed of the simulation with other fields. */
+    const std::string TRACE = "test_trace.www";   /** recorded trace file.                      */
+    const std::string BROKEN = "test_broken.www"; /** modified copies of the trace.             */
+    const std::size_t HEADER_SIZE = 24;           /** bytes of the trace header.                */
+    const std::size_t SEED_OFFSET = 8;            /** offset of the seed in the header.         */
+
+    /** \brief Returns true if the traced fields of both states are equal: the enabled fields and their parameters,
+     * velocities and accelerations.
+     *
+     */
+    bool equalFields(const State& a, const State& b)
+    {
+        return std::equal(a.enabled, a.enabled + fs, b.enabled) && std::memcmp(a.var, b.var, sizeof(a.var)) == 0 &&
+               std::memcmp(a.velocity, b.velocity, sizeof(a.velocity)) == 0 &&
+               std::memcmp(a.acceleration, b.acceleration, sizeof(a.acceleration)) == 0;
+    }
+
+    /** \brief Returns true if the traced values of both states are equal, the fields and the hue.
+     *
+     */
+    bool equal(const State& a, const State& b)
+    {
+        return equalFields(a, b) && a.hue == b.hue;
+    }
+
+    /** \brief Returns the positions of the particles of the simulation.
+     *
+     */
+    std::vector<float> positions(WhirlWindWarp& www)
+    {
+        std::vector<float> data(www.particles().positionsSize());
+        www.particles().fillPositions(data.data());
+        return data;
+    }
+
+    /** \brief Returns the bytes of the given file.
+     * \param[in] filename file name.
+     *
+     */
+    std::string readFile(const std::string& filename)
+    {
+        std::ifstream file(filename, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    /** \brief Writes the given bytes to the given file.
+     * \param[in] filename file name.
+     * \param[in] bytes file contents.
+     *
+     */
+    void writeFile(const std::string& filename, const std::string& bytes)
+    {
+        std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+        file.write(bytes.data(), bytes.size());
+    }
+
+    /** \brief Records FRAMES frames of the given simulation to the given trace file and returns the state of every
+     * frame: the fields written to the trace before advancing and the hue after it, the particles step the hue after
+     * a color change.
+     * \param[in] www simulation.
+     * \param[in] filename trace file name.
+     * \param[out] frames positions after every frame.
+     *
+     */
+    std::vector<State> record(WhirlWindWarp& www, const std::string& filename, std::vector<std::vector<float>>& frames)
+    {
+        std::vector<State> states;
+        if (!www.startRecording(filename)) {
+            return states;
+        }
+
+        for (int frame = 0; frame < FRAMES; ++frame) {
+            states.push_back(www.state());
+            www.advance();
+            states.back().hue = www.state().hue;
+            frames.push_back(positions(www));
+        }
+
+        return states;
+    }
+} // namespace
+
+//--------------------------------------------------------------------
+int main()
+{
+    const Utils::Configuration config;
+    bool passed = true;
+
+    std::vector<std::vector<float>> recordedPositions;
+    std::vector<State> recordedStates;
+    {
+        WhirlWindWarp www(POINTS, config, SEED);
+        recordedStates = record(www, TRACE, recordedPositions);
+    }
+    passed &= TestUtils::report("record " + std::to_string(FRAMES) + " frames", recordedStates.size() == FRAMES);
+
+    // The replay of a fresh simulation applies the same state and moves the particles to the same positions.
+    {
+        WhirlWindWarp www(POINTS, config, SEED);
+        const bool started = www.startReplay(TRACE);
+        int firstDifference = started ? -1 : 0;
+        for (int frame = 0; started && frame < FRAMES; ++frame) {
+            www.advance();
+            if (firstDifference < 0 &&
+                (!equal(www.state(), recordedStates[frame]) || positions(www) != recordedPositions[frame])) {
+                firstDifference = frame;
+            }
+        }
+
+        const std::string details = firstDifference < 0 ? std::to_string(FRAMES) + " frames with the same bits"
+                                                         : "differs at frame " + std::to_string(firstDifference);
+        passed &= TestUtils::report("replay equals the recording", firstDifference < 0, details);
+    }
+
+    // The fields come from the trace, not from the random schedule: the trace of another simulation with the
+    // header of this one drives its fields. The hue after a frame depends on the color changes of the particles.
+    {
+        std::vector<std::vector<float>> otherPositions;
+        std::vector<State> otherStates;
+        {
+            WhirlWindWarp other(POINTS, config, OTHER_SEED);
+            otherStates = record(other, BROKEN, otherPositions);
+        }
+
+        auto bytes = readFile(BROKEN);
+        std::memcpy(&bytes[SEED_OFFSET], &SEED, sizeof(SEED));
+        writeFile(BROKEN, bytes);
+
+        WhirlWindWarp www(POINTS, config, SEED);
+        bool follows = www.startReplay(BROKEN) && otherStates.size() == FRAMES;
+        for (int frame = 0; follows && frame < FRAMES; ++frame) {
+            www.advance();
+            follows &= equalFields(www.state(), otherStates[frame]);
+        }
+        passed &= TestUtils::report("replay follows the fields of the trace", follows);
+    }
+
+    // Rejected traces.
+    {
+        const auto bytes = readFile(TRACE);
+
+        WhirlWindWarp otherSeed(POINTS, config, OTHER_SEED);
+        passed &= TestUtils::report("replay rejects another seed", !otherSeed.startReplay(TRACE));
+
+        WhirlWindWarp otherPoints(POINTS + 1000, config, SEED);
+        passed &= TestUtils::report("replay rejects another number of points", !otherPoints.startReplay(TRACE));
+
+        WhirlWindWarp www(POINTS, config, SEED);
+        passed &= TestUtils::report("replay rejects a missing file", !www.startReplay("test_missing.www"));
+
+        auto wrongMagic = bytes;
+        wrongMagic[0] = 'X';
+        writeFile(BROKEN, wrongMagic);
+        passed &= TestUtils::report("replay rejects a wrong magic", !www.startReplay(BROKEN));
+
+        writeFile(BROKEN, bytes.substr(0, HEADER_SIZE - 1));
+        passed &= TestUtils::report("replay rejects a truncated header", !www.startReplay(BROKEN));
+
+        // A frame cut in half ends the replay after the whole frames, without applying the partial one.
+        const auto frameSize = (bytes.size() - HEADER_SIZE) / FRAMES;
+        writeFile(BROKEN, bytes.substr(0, HEADER_SIZE + 10 * frameSize + frameSize / 2));
+        bool truncated = www.startReplay(BROKEN);
+        for (int frame = 0; truncated && frame < 10; ++frame) {
+            www.advance();
+            truncated &= www.replaying() && equal(www.state(), recordedStates[frame]);
+        }
+        www.advance();
+        truncated &= !www.replaying();
+        passed &= TestUtils::report("replay of a truncated frame ends after the whole frames", truncated);
+    }
+
+    std::remove(TRACE.c_str());
+    std::remove(BROKEN.c_str());
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}